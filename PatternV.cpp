@@ -10,10 +10,80 @@
 #include <future>
 #include <semaphore>
 #include <cstring>
+#include <optional>
+#include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <random>
+#include <cmath>
+#include <limits>
+#include <string_view>
+#include <utility>
+#include <unordered_map>
+#include <iomanip>
+#include <array>
+#include <functional>
+#include <tuple>
+#include <numeric>
+#include <memory>
+#include <iterator>
+#include <deque>
+#include <map>
+#include <condition_variable>
+#include <bit>
+#include <cerrno>
+#include <charconv>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PATTERNV_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#endif
 
 bool useColors = true;
+bool useManifest = true;
+bool skipOpaque = false;
+bool annotateSymbols = false;
 bool hideTime = false;
 bool minifiedOutput = false;
+bool countOnlyOutput = false;
+bool csvOutput = false;
+bool profileSignatures = false;
+bool interactiveMode = false;
+size_t estimateThreshold = 10000;
+bool localitySearch = false;
+bool proveUnique = false;
+size_t localityWindow = 4096;
+size_t maxMismatches = 0;
+size_t maxEditDistance = 0;
+
+// Cooperative cancellation: Ctrl-C while a scan is running and the per-query
+// --timeout deadline are both polled once per scanned chunk.
+std::atomic<bool> scanInProgress{ false };
+std::atomic<bool> scanCancelled{ false };
+std::atomic<bool> scanTimedOut{ false };
+std::chrono::milliseconds queryTimeout{ 0 };
+std::chrono::steady_clock::time_point scanDeadline;
 
 #define RED     (useColors ? "\033[31m" : "")
 #define GREEN   (useColors ? "\033[32m" : "")
@@ -22,24 +92,239 @@ bool minifiedOutput = false;
 
 namespace fs = std::filesystem;
 
+using BytePattern = std::vector<std::optional<uint8_t>>;
+
 constexpr auto TARGET_EXTENSION_EXE = ".exe";
 constexpr auto TARGET_EXTENSION_TEXT = ".text";
+constexpr size_t SCAN_CHUNK_SIZE = 1 << 20;
+constexpr size_t PE_HEADER_READ_SIZE = 0x1000;
+
+// Pre-scan match estimation: random windows from a few evenly spaced builds.
+constexpr size_t ESTIMATE_BUILDS = 3;
+constexpr size_t ESTIMATE_WINDOWS_PER_BUILD = 32;
+constexpr size_t ESTIMATE_WINDOW_SIZE = 64 * 1024;
+constexpr size_t ESTIMATE_MAX_FIXED_BYTES = 8;
+
+// Scan pipeline: threads per I/O stage and depth of the queues between stages.
+constexpr size_t PIPELINE_PARSE_WORKERS = 2;
+constexpr size_t PIPELINE_LOAD_WORKERS = 4;
+constexpr size_t PIPELINE_QUEUE_DEPTH = 64;
 
 struct ResultLine {
     int build;
     std::string line;
+    bool incomplete = false;
 };
 
+// Where a section's bytes sit in the file (at PointerToRawData for an image on disk, at
+// its VirtualAddress for a memory dump), plus what is needed to turn offsets into RVAs
+// and VAs.
 struct SectionInfo {
     size_t rawOffset;
     size_t rawSize;
+    uint32_t virtualAddress = 0;
+    uint64_t imageBase = 0;
+};
+
+struct TextRange {
+    size_t offset;
+    size_t length;
+};
+
+struct PeSection {
+    std::string name;
+    uint32_t virtualAddress = 0;
+    uint32_t virtualSize = 0;
+    uint32_t rawOffset = 0;
+    uint32_t rawSize = 0;
+};
+
+struct PeHeaders {
+    uint64_t imageBase = 0;
+    uint32_t sizeOfImage = 0;
+    std::vector<PeSection> sections;
+};
+
+// File layout is a PE as written by the linker; memory layout is an image dumped from a
+// running process, where every section sits at its VirtualAddress.
+enum class ImageLayout { Auto, File, Memory };
+ImageLayout imageLayout = ImageLayout::Auto;
+
+// Ascending match offsets stored as LEB128-encoded deltas, so dense result sets
+// cost 1-2 bytes per match instead of 8. Offsets must be appended in order.
+class MatchSet {
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = size_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const size_t*;
+        using reference = size_t;
+
+        Iterator() = default;
+        Iterator(const uint8_t* pos, const uint8_t* end) : pos(pos), end(end) { decode(); }
+
+        size_t operator*() const { return value; }
+        Iterator& operator++() { pos = next; decode(); return *this; }
+        Iterator operator++(int) { Iterator copy = *this; ++*this; return copy; }
+        bool operator==(const Iterator& other) const { return pos == other.pos; }
+        bool operator!=(const Iterator& other) const { return pos != other.pos; }
+
+    private:
+        void decode() {
+            if (pos == end) return;
+            size_t delta = 0;
+            int shift = 0;
+            next = pos;
+            while (true) {
+                const uint8_t byte = *next++;
+                delta |= static_cast<size_t>(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) break;
+                shift += 7;
+            }
+            value += delta;
+        }
+
+        const uint8_t* pos = nullptr;
+        const uint8_t* next = nullptr;
+        const uint8_t* end = nullptr;
+        size_t value = 0;
+    };
+
+    void push_back(size_t offset) {
+        size_t delta = offset - lastOffset;
+        while (delta >= 0x80) {
+            bytes.push_back(static_cast<uint8_t>(delta | 0x80));
+            delta >>= 7;
+        }
+        bytes.push_back(static_cast<uint8_t>(delta));
+        lastOffset = offset;
+        ++count;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t back() const { return lastOffset; }
+    size_t encodedSize() const { return bytes.size(); }
+
+    Iterator begin() const { return Iterator(bytes.data(), bytes.data() + bytes.size()); }
+    Iterator end() const { return Iterator(bytes.data() + bytes.size(), bytes.data() + bytes.size()); }
+
+private:
+    std::vector<uint8_t> bytes;
+    size_t count = 0;
+    size_t lastOffset = 0;
+};
+
+struct BuildImage {
+    fs::path path;
+    std::string filename;
+    std::string gameName;
+    std::string build;
+    int buildNumber = 0;
+    std::vector<uint8_t> buffer;
+    size_t textOffset = 0;
+    size_t textSize = 0;
+    uint32_t textRva = 0;
+    uint64_t imageBase = 0;
+
+    const uint8_t* text() const { return buffer.data() + textOffset; }
+};
+
+struct MatchEstimate {
+    double perBuild;
+    double low;
+    double high;
+    size_t sampledBytes;
 };
 
 std::counting_semaphore<> sem(std::thread::hardware_concurrency());
 
-std::vector<std::optional<uint8_t>> parseBytePattern(const std::string& input)
+void handleInterrupt(int)
+{
+    if (!scanInProgress.load()) {
+        std::_Exit(130);
+    }
+    scanCancelled.store(true);
+    std::signal(SIGINT, handleInterrupt);
+}
+
+void beginScan()
+{
+    scanCancelled.store(false);
+    scanTimedOut.store(false);
+    scanDeadline = std::chrono::steady_clock::now() + queryTimeout;
+    scanInProgress.store(true);
+}
+
+void endScan()
+{
+    scanInProgress.store(false);
+}
+
+bool scanInterrupted()
+{
+    if (scanCancelled.load(std::memory_order_relaxed) || scanTimedOut.load(std::memory_order_relaxed))
+        return true;
+
+    if (queryTimeout.count() > 0 && std::chrono::steady_clock::now() >= scanDeadline) {
+        scanTimedOut.store(true);
+        return true;
+    }
+
+    return false;
+}
+
+// Typed capture inside a pattern, written `{type}` or `{type:name}`. It stands for as many
+// wildcards as the type is wide, and its value is decoded at every match.
+enum class CaptureType : uint32_t { U8, U16, U32, I32, Rel32, U64 };
+
+struct Capture {
+    std::string name;
+    CaptureType type;
+    size_t offset;
+};
+
+constexpr std::pair<const char*, CaptureType> CAPTURE_TYPES[] = {
+    { "u8", CaptureType::U8 }, { "u16", CaptureType::U16 }, { "u32", CaptureType::U32 },
+    { "i32", CaptureType::I32 }, { "rel32", CaptureType::Rel32 }, { "u64", CaptureType::U64 },
+};
+
+size_t captureSize(CaptureType type) {
+    switch (type) {
+    case CaptureType::U8: return 1;
+    case CaptureType::U16: return 2;
+    case CaptureType::U64: return 8;
+    default: return 4;
+    }
+}
+
+// Little-endian value of a capture for the match at `matchOffset`. Integers print in hex,
+// i32 with a sign; rel32 is resolved to the .text offset it points to, assuming the
+// displacement ends the instruction.
+std::string decodeCapture(const uint8_t* data, size_t matchOffset, const Capture& capture) {
+    const uint8_t* field = data + matchOffset + capture.offset;
+    uint64_t raw = 0;
+    for (size_t i = captureSize(capture.type); i-- > 0;) raw = (raw << 8) | field[i];
+
+    std::ostringstream oss;
+    oss << std::hex << std::uppercase;
+    if (capture.type == CaptureType::I32) {
+        const auto value = static_cast<int32_t>(raw);
+        oss << (value < 0 ? "-0x" : "0x") << (value < 0 ? -int64_t(value) : int64_t(value));
+    } else if (capture.type == CaptureType::Rel32) {
+        const int64_t target = int64_t(matchOffset + capture.offset + 4) + static_cast<int32_t>(raw);
+        oss << (target < 0 ? "-0x" : "0x") << (target < 0 ? -target : target);
+    } else {
+        oss << "0x" << raw;
+    }
+    return oss.str();
+}
+
+BytePattern parseBytePattern(const std::string& input, std::vector<Capture>* captures = nullptr)
 {
-    std::vector<std::optional<uint8_t>> pattern;
+    BytePattern pattern;
     std::istringstream stream(input);
     std::string byteStr;
 
@@ -49,6 +334,27 @@ std::vector<std::optional<uint8_t>> parseBytePattern(const std::string& input)
         {
             pattern.push_back(std::nullopt);
         }
+        else if (byteStr.front() == '{' && byteStr.back() == '}')
+        {
+            const std::string spec = byteStr.substr(1, byteStr.size() - 2);
+            const size_t colon = spec.find(':');
+            const std::string typeName = spec.substr(0, colon);
+            const auto* type = std::find_if(std::begin(CAPTURE_TYPES), std::end(CAPTURE_TYPES),
+                                            [&](const auto& entry) { return typeName == entry.first; });
+            if (type == std::end(CAPTURE_TYPES))
+            {
+                std::cerr << "Invalid capture: " << byteStr << "\n";
+                continue;
+            }
+
+            if (captures)
+            {
+                std::string name = colon == std::string::npos ? "" : spec.substr(colon + 1);
+                if (name.empty()) name = typeName + "_" + std::to_string(captures->size() + 1);
+                captures->push_back({ name, type->second, pattern.size() });
+            }
+            pattern.insert(pattern.end(), captureSize(type->second), std::nullopt);
+        }
         else
         {
             try
@@ -66,19 +372,30 @@ std::vector<std::optional<uint8_t>> parseBytePattern(const std::string& input)
     return pattern;
 }
 
-std::vector<size_t> searchAllPatternOffsets(const uint8_t* data, size_t size, const std::vector<std::optional<uint8_t>>& pattern) {
-    std::vector<size_t> matches;
+MatchSet searchAllPatternOffsets(const uint8_t* data, size_t size, const BytePattern& pattern,
+                                 bool* complete = nullptr) {
+    MatchSet matches;
+    if (complete) *complete = true;
     if (size < pattern.size()) return matches;
 
-    for (size_t i = 0; i <= size - pattern.size(); ++i) {
-        bool matched = true;
-        for (size_t j = 0; j < pattern.size(); ++j) {
-            if (pattern[j].has_value() && data[i + j] != pattern[j].value()) {
-                matched = false;
-                break;
+    const size_t last = size - pattern.size();
+    for (size_t chunk = 0; chunk <= last; chunk += SCAN_CHUNK_SIZE) {
+        if (scanInterrupted()) {
+            if (complete) *complete = false;
+            break;
+        }
+
+        const size_t chunkEnd = std::min(last, chunk + SCAN_CHUNK_SIZE - 1);
+        for (size_t i = chunk; i <= chunkEnd; ++i) {
+            bool matched = true;
+            for (size_t j = 0; j < pattern.size(); ++j) {
+                if (pattern[j].has_value() && data[i + j] != pattern[j].value()) {
+                    matched = false;
+                    break;
+                }
             }
+            if (matched) matches.push_back(i);
         }
-        if (matched) matches.push_back(i);
     }
 
     return matches;
@@ -125,6 +442,271 @@ std::vector<uint8_t> readFile(const fs::path& filepath) {
     return buffer;
 }
 
+std::vector<uint8_t> readFileRange(const fs::path& filepath, size_t offset, size_t size) {
+    std::ifstream file(filepath, std::ios::binary);
+    if (!file) {
+        std::cerr << "Failed to open: " << filepath << '\n';
+        return {};
+    }
+
+    file.seekg(static_cast<std::streamoff>(offset));
+    std::vector<uint8_t> buffer(size);
+    file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(size));
+    buffer.resize(static_cast<size_t>(file.gcount()));
+    return buffer;
+}
+
+uint64_t hashBytes(const uint8_t* data, size_t length) {
+    uint64_t hash = 0x9E3779B97F4A7C15ull ^ length;
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 32;
+    }
+    for (; i < length; ++i) hash = (hash ^ data[i]) * 0x100000001B3ull;
+    return hash ^ (hash >> 29);
+}
+
+// Read-only memory mapping of a whole file.
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept { *this = std::move(other); }
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            close();
+            view = std::exchange(other.view, nullptr);
+            length = std::exchange(other.length, 0);
+#ifdef _WIN32
+            fileHandle = std::exchange(other.fileHandle, nullptr);
+            mappingHandle = std::exchange(other.mappingHandle, nullptr);
+#endif
+        }
+        return *this;
+    }
+
+    ~MappedFile() { close(); }
+
+    bool open(const fs::path& filepath) {
+        close();
+#ifdef _WIN32
+        HANDLE file = CreateFileW(filepath.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+
+        LARGE_INTEGER fileSize{};
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+            CloseHandle(file);
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) {
+            CloseHandle(file);
+            return false;
+        }
+
+        view = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (!view) {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+
+        fileHandle = file;
+        mappingHandle = mapping;
+        length = static_cast<size_t>(fileSize.QuadPart);
+#else
+        const int fd = ::open(filepath.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+
+        struct stat st{};
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+            ::close(fd);
+            return false;
+        }
+
+        void* mapped = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) return false;
+
+        view = static_cast<const uint8_t*>(mapped);
+        length = static_cast<size_t>(st.st_size);
+#endif
+        return true;
+    }
+
+    void close() {
+        if (!view) return;
+#ifdef _WIN32
+        UnmapViewOfFile(view);
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+        fileHandle = nullptr;
+        mappingHandle = nullptr;
+#else
+        munmap(const_cast<uint8_t*>(view), length);
+#endif
+        view = nullptr;
+        length = 0;
+    }
+
+    const uint8_t* data() const { return view; }
+    size_t size() const { return length; }
+
+private:
+    const uint8_t* view = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    HANDLE fileHandle = nullptr;
+    HANDLE mappingHandle = nullptr;
+#endif
+};
+
+// Named shared-memory segment (POSIX shm / a Windows pagefile-backed mapping). The creator
+// maps it writable and removes the name again when closing it; others map it read-only.
+class SharedSegment {
+public:
+    SharedSegment() = default;
+    SharedSegment(const SharedSegment&) = delete;
+    SharedSegment& operator=(const SharedSegment&) = delete;
+    SharedSegment(SharedSegment&& other) noexcept { *this = std::move(other); }
+
+    SharedSegment& operator=(SharedSegment&& other) noexcept {
+        if (this != &other) {
+            close();
+            view = std::exchange(other.view, nullptr);
+            length = std::exchange(other.length, 0);
+            owner = std::exchange(other.owner, false);
+            segmentName = std::move(other.segmentName);
+#ifdef _WIN32
+            mappingHandle = std::exchange(other.mappingHandle, nullptr);
+#endif
+        }
+        return *this;
+    }
+
+    ~SharedSegment() { close(); }
+
+    bool create(const std::string& name, size_t size) {
+        close();
+#ifdef _WIN32
+        const auto wideName = segmentPath(name);
+        HANDLE mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                            static_cast<DWORD>(uint64_t(size) >> 32), static_cast<DWORD>(size),
+                                            wideName.c_str());
+        if (!mapping) return false;
+        if (GetLastError() == ERROR_ALREADY_EXISTS) {
+            CloseHandle(mapping);
+            return false;
+        }
+
+        view = static_cast<uint8_t*>(MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size));
+        if (!view) {
+            CloseHandle(mapping);
+            return false;
+        }
+        mappingHandle = mapping;
+#else
+        const auto path = segmentPath(name);
+        const int fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0) return false;
+
+        void* mapped = ftruncate(fd, static_cast<off_t>(size)) == 0
+            ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+            : MAP_FAILED;
+        ::close(fd);
+        if (mapped == MAP_FAILED) {
+            shm_unlink(path.c_str());
+            return false;
+        }
+        view = static_cast<uint8_t*>(mapped);
+#endif
+        length = size;
+        owner = true;
+        segmentName = name;
+        return true;
+    }
+
+    bool open(const std::string& name) {
+        close();
+#ifdef _WIN32
+        HANDLE mapping = OpenFileMappingW(FILE_MAP_READ, FALSE, segmentPath(name).c_str());
+        if (!mapping) return false;
+
+        view = static_cast<uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        MEMORY_BASIC_INFORMATION info{};
+        if (!view || !VirtualQuery(view, &info, sizeof(info))) {
+            if (view) UnmapViewOfFile(view);
+            view = nullptr;
+            CloseHandle(mapping);
+            return false;
+        }
+        mappingHandle = mapping;
+        length = info.RegionSize;
+#else
+        const int fd = shm_open(segmentPath(name).c_str(), O_RDONLY, 0);
+        if (fd < 0) return false;
+
+        struct stat st{};
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+            ::close(fd);
+            return false;
+        }
+
+        void* mapped = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) return false;
+
+        view = static_cast<uint8_t*>(mapped);
+        length = static_cast<size_t>(st.st_size);
+#endif
+        segmentName = name;
+        return true;
+    }
+
+    void close() {
+        if (!view) return;
+#ifdef _WIN32
+        UnmapViewOfFile(view);
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+#else
+        munmap(view, length);
+        if (owner) shm_unlink(segmentPath(segmentName).c_str());
+#endif
+        view = nullptr;
+        length = 0;
+        owner = false;
+    }
+
+    uint8_t* data() { return view; }
+    const uint8_t* data() const { return view; }
+    size_t size() const { return length; }
+
+private:
+#ifdef _WIN32
+    static std::wstring segmentPath(const std::string& name) {
+        return L"Local\\PatternV." + std::wstring(name.begin(), name.end());
+    }
+#else
+    static std::string segmentPath(const std::string& name) { return "/PatternV." + name; }
+#endif
+
+    uint8_t* view = nullptr;
+    size_t length = 0;
+    bool owner = false;
+    std::string segmentName;
+#ifdef _WIN32
+    HANDLE mappingHandle = nullptr;
+#endif
+};
+
 std::string extractGameName(const std::string& filename) {
     std::string nameOnly = filename.substr(0, filename.find_last_of('.'));
 
@@ -152,120 +734,108 @@ std::optional<std::string> extractBuildNumber(const std::string& filename) {
     return std::nullopt;
 }
 
-std::optional<SectionInfo> getTextSection(const std::vector<uint8_t>& buffer) {
-    if (buffer.size() < 0x1000) return std::nullopt;
+// `buffer` must hold at least the PE headers.
+PeHeaders readPeHeaders(const std::vector<uint8_t>& buffer) {
+    PeHeaders headers;
+    auto& sections = headers.sections;
+    if (buffer.size() < PE_HEADER_READ_SIZE) return headers;
 
     const uint32_t dosSignature = *reinterpret_cast<const uint16_t*>(&buffer[0x00]);
-    if (dosSignature != 0x5A4D) return std::nullopt; // MZ
+    if (dosSignature != 0x5A4D) return headers; // MZ
 
     const uint32_t peOffset = *reinterpret_cast<const uint32_t*>(&buffer[0x3C]);
-    if (peOffset + 0x18 >= buffer.size()) return std::nullopt;
+    if (peOffset + 0x18 >= buffer.size()) return headers;
 
     const uint32_t peSignature = *reinterpret_cast<const uint32_t*>(&buffer[peOffset]);
-    if (peSignature != 0x00004550) return std::nullopt; // PE\0\0
+    if (peSignature != 0x00004550) return headers; // PE\0\0
 
     const uint16_t numberOfSections = *reinterpret_cast<const uint16_t*>(&buffer[peOffset + 6]);
     const uint16_t sizeOfOptionalHeader = *reinterpret_cast<const uint16_t*>(&buffer[peOffset + 20]);
 
+    const size_t optionalHeader = peOffset + 24;
+    if (sizeOfOptionalHeader >= 60 && optionalHeader + 60 <= buffer.size()) {
+        const uint16_t magic = *reinterpret_cast<const uint16_t*>(&buffer[optionalHeader]);
+        headers.imageBase = magic == 0x20B ? *reinterpret_cast<const uint64_t*>(&buffer[optionalHeader + 24]) // PE32+
+                                           : *reinterpret_cast<const uint32_t*>(&buffer[optionalHeader + 28]);
+        headers.sizeOfImage = *reinterpret_cast<const uint32_t*>(&buffer[optionalHeader + 56]);
+    }
+
     size_t sectionTableOffset = peOffset + 24 + sizeOfOptionalHeader;
     for (int i = 0; i < numberOfSections; ++i) {
         if (sectionTableOffset + 40 > buffer.size()) break;
 
         const char* name = reinterpret_cast<const char*>(&buffer[sectionTableOffset]);
-        if (std::strncmp(name, ".text", 5) == 0) {
-            const uint32_t rawDataPtr = *reinterpret_cast<const uint32_t*>(&buffer[sectionTableOffset + 20]);
-            const uint32_t rawSize = *reinterpret_cast<const uint32_t*>(&buffer[sectionTableOffset + 16]);
-            if (rawDataPtr + rawSize <= buffer.size()) {
-                return SectionInfo{ rawDataPtr, rawSize };
-            }
-        }
+        PeSection section;
+        section.name.assign(name, strnlen(name, 8));
+        section.virtualSize = *reinterpret_cast<const uint32_t*>(&buffer[sectionTableOffset + 8]);
+        section.virtualAddress = *reinterpret_cast<const uint32_t*>(&buffer[sectionTableOffset + 12]);
+        section.rawSize = *reinterpret_cast<const uint32_t*>(&buffer[sectionTableOffset + 16]);
+        section.rawOffset = *reinterpret_cast<const uint32_t*>(&buffer[sectionTableOffset + 20]);
+        sections.push_back(std::move(section));
 
         sectionTableOffset += 40;
     }
 
-    return std::nullopt;
+    return headers;
 }
 
-void scanFile(const fs::path& filePath, const std::vector<std::optional<uint8_t>>& pattern,
-              std::mutex& outputMutex, std::vector<ResultLine>& outputBuffer)
-{
-    const auto filename = filePath.filename().string();
-    const auto buffer = readFile(filePath);
-    if (buffer.empty()) return;
-
-    const uint8_t* textSegment = nullptr;
-    size_t textSize = 0;
+// Auto-detection: a dump is recognised when the raw layout cannot fit in the file but
+// the virtual one does, or when the file is exactly SizeOfImage long and does not end
+// where the last section's raw data does.
+bool isMemoryLayout(const PeHeaders& headers, size_t fileSize) {
+    if (imageLayout != ImageLayout::Auto) return imageLayout == ImageLayout::Memory;
+    if (headers.sections.empty()) return false;
 
-    if (filePath.extension() == TARGET_EXTENSION_TEXT) {
-        textSegment = buffer.data();
-        textSize = buffer.size();
-    } else {
-        auto textSection = getTextSection(buffer);
-        if (!textSection.has_value()) {
-            std::lock_guard lock(outputMutex);
-            std::cerr << RED << "[-] .text section not found in: " << filename << RESET << '\n';
-            return;
-        }
-        textSegment = buffer.data() + textSection->rawOffset;
-        textSize = textSection->rawSize;
+    bool rawFits = true;
+    bool virtualFits = true;
+    size_t rawEnd = 0;
+    for (const auto& section : headers.sections) {
+        rawFits &= static_cast<size_t>(section.rawOffset) + section.rawSize <= fileSize;
+        virtualFits &= static_cast<size_t>(section.virtualAddress) + section.virtualSize <= fileSize;
+        rawEnd = std::max(rawEnd, static_cast<size_t>(section.rawOffset) + section.rawSize);
     }
 
-    const auto gameName = extractGameName(filename);
-    const auto build = extractBuildNumber(filename).value_or(filename);
-    const auto matches = searchAllPatternOffsets(textSegment, textSize, pattern);
+    if (!rawFits) return virtualFits;
+    return virtualFits && fileSize == headers.sizeOfImage && rawEnd != fileSize;
+}
 
-    std::ostringstream oss;
-    if (!matches.empty()) {
-        if (minifiedOutput) {
-            oss << GREEN << "[+] " << RESET << gameName << "_" << build << " (" << matches.size() << " matches): ";
-            for (size_t i = 0; i < matches.size(); ++i) {
-                oss << "0x" << std::hex << std::uppercase << matches[i];
-                if (i != matches.size() - 1)
-                    oss << ", ";
-            }
-        } else {
-            oss << GREEN << "[+]" << RESET << " Pattern found in " << gameName << " v" << YELLOW << build
-                << RESET << " (" << matches.size() << " matches): ";
-            for (size_t i = 0; i < matches.size(); ++i) {
-                oss << YELLOW << "0x" << std::hex << std::uppercase << matches[i] << RESET;
-                if (i != matches.size() - 1)
-                    oss << ", ";
-            }
-        }
-    } else {
-        if (minifiedOutput) {
-            oss << RED << "[-] " << RESET << gameName << "_" << build << " (0 matches)";
-        } else {
-            oss << RED << "[-]" << RESET << " Pattern not found in " << gameName << " v" << YELLOW << build << RESET;
-        }
-    }
+// `fileSize` bounds the section's data, which lets callers locate .text from a
+// header-only read.
+std::optional<SectionInfo> findTextSection(const PeHeaders& headers, size_t fileSize) {
+    const bool memoryLayout = isMemoryLayout(headers, fileSize);
+    for (const auto& section : headers.sections) {
+        if (!section.name.starts_with(".text")) continue;
 
-    {
-        std::lock_guard lock(outputMutex);
-        try {
-            int buildNum = std::stoi(build);
-            outputBuffer.push_back({ buildNum, oss.str() });
-        } catch (...) {
-            outputBuffer.push_back({ 0, oss.str() });
+        if (memoryLayout) {
+            if (section.virtualAddress >= fileSize) continue;
+            const size_t size = std::min<size_t>(section.virtualSize ? section.virtualSize : section.rawSize,
+                                                 fileSize - section.virtualAddress);
+            return SectionInfo{ section.virtualAddress, size, section.virtualAddress, headers.imageBase };
+        }
+        if (static_cast<size_t>(section.rawOffset) + section.rawSize <= fileSize) {
+            return SectionInfo{ section.rawOffset, section.rawSize, section.virtualAddress, headers.imageBase };
         }
     }
+    return std::nullopt;
 }
 
-void scanFileLimited(const fs::path& filePath, const std::vector<std::optional<uint8_t>>& pattern, std::mutex& outputMutex, std::vector<ResultLine>& outputBuffer)
-{
-    sem.acquire();
-    scanFile(filePath, pattern, outputMutex, outputBuffer);
-    sem.release();
+std::optional<SectionInfo> getTextSection(const std::vector<uint8_t>& buffer, size_t fileSize) {
+    return findTextSection(readPeHeaders(buffer), fileSize);
 }
 
-bool scanDirectory(const fs::path& folderPath, const std::vector<std::optional<uint8_t>>& pattern) {
-    using namespace std::chrono;
-    const auto start = high_resolution_clock::now();
+std::optional<SectionInfo> getTextSection(const std::vector<uint8_t>& buffer) {
+    return getTextSection(buffer, buffer.size());
+}
 
-    std::vector<ResultLine> outputBuffer;
-    std::mutex outputMutex;
-    std::vector<std::future<void>> futures;
+int parseBuildNumber(const std::string& build) {
+    try {
+        return std::stoi(build);
+    } catch (...) {
+        return 0;
+    }
+}
 
+std::vector<fs::path> listBuildFiles(const fs::path& folderPath) {
     std::vector<fs::path> buildFiles;
     for (const auto& entry : fs::directory_iterator(folderPath)) {
         if (entry.is_regular_file()) {
@@ -275,47 +845,5000 @@ bool scanDirectory(const fs::path& folderPath, const std::vector<std::optional<u
             }
         }
     }
+    return buildFiles;
+}
 
-    for (const auto& path : buildFiles) {
-        futures.push_back(std::async(std::launch::async, scanFileLimited,
-                                     path, std::cref(pattern),
-                                     std::ref(outputMutex), std::ref(outputBuffer)));
+// Rough frequency class of a byte in x64 code; anchors avoid the common ones.
+int byteCommonness(uint8_t byte) {
+    switch (byte) {
+    case 0x00: case 0xFF: case 0xCC: case 0x90: case 0x48: case 0x8B: case 0x89:
+        return 4;
+    case 0x0F: case 0xE8: case 0x4C: case 0x24: case 0x44: case 0x8D: case 0xC3:
+    case 0x83: case 0x85: case 0x74: case 0x75: case 0xEB: case 0x33: case 0xC0:
+    case 0x40: case 0x41: case 0x49: case 0x01: case 0x20: case 0x08: case 0x10:
+        return 2;
+    default:
+        return 1;
     }
+}
 
-    for (auto& f : futures) f.get();
+// Opaque region classification (--skip-opaque): .text is cut into ENTROPY_BLOCK_SIZE
+// blocks, and a block counts as encrypted or packed when its byte entropy is close to
+// random and it lacks the opcode and prefix bytes that dominate x64 code. Adjacent
+// opaque blocks are merged into ranges, which the manifest caches per build.
+constexpr size_t ENTROPY_BLOCK_SIZE = 4096;
+constexpr double OPAQUE_MIN_ENTROPY = 7.2;      // bits per byte; compiled x64 sits near 6
+constexpr double OPAQUE_MAX_CODE_DENSITY = 0.2; // share of common code bytes; random data has ~0.11
 
-    bool allFound = true;
-    {
-        std::lock_guard lock(outputMutex);
-        std::sort(outputBuffer.begin(), outputBuffer.end(),
-                  [](const ResultLine& a, const ResultLine& b) {
-                      return a.build < b.build;
-                  });
+std::vector<TextRange> classifyOpaqueRegions(const uint8_t* data, size_t size) {
+    std::vector<TextRange> ranges;
+    for (size_t begin = 0; begin < size; begin += ENTROPY_BLOCK_SIZE) {
+        const size_t length = std::min(ENTROPY_BLOCK_SIZE, size - begin);
+        std::array<uint32_t, 256> counts{};
+        size_t codeBytes = 0;
+        for (size_t i = begin; i < begin + length; ++i) {
+            ++counts[data[i]];
+            codeBytes += byteCommonness(data[i]) > 1;
+        }
 
-        for (const auto& result : outputBuffer) {
-            std::cout << result.line << '\n';
-            if (result.line.find("Pattern not found") != std::string::npos) {
-                allFound = false;
-            }
+        double entropy = 0;
+        for (uint32_t count : counts) {
+            if (count == 0) continue;
+            const double p = static_cast<double>(count) / static_cast<double>(length);
+            entropy -= p * std::log2(p);
         }
-    }
 
-    const auto end = high_resolution_clock::now();
-    if (!hideTime) {
-        std::cout << "\n[~] Scan completed in "
-                << duration_cast<milliseconds>(end - start).count()
-                << " ms\n";
+        const double codeDensity = static_cast<double>(codeBytes) / static_cast<double>(length);
+        if (entropy < OPAQUE_MIN_ENTROPY || codeDensity > OPAQUE_MAX_CODE_DENSITY) continue;
+
+        if (!ranges.empty() && ranges.back().offset + ranges.back().length == begin) ranges.back().length += length;
+        else ranges.push_back({ begin, length });
     }
+    return ranges;
+}
 
-    return allFound;
+// Calls `visit(begin, end)` for every stretch of [0, size) outside the sorted, disjoint
+// `skipped` ranges.
+template <typename Visit>
+void forEachKeptRange(const std::vector<TextRange>& skipped, size_t size, Visit visit) {
+    size_t begin = 0;
+    for (const auto& range : skipped) {
+        if (range.offset > begin) visit(begin, std::min(range.offset, size));
+        begin = std::max(begin, range.offset + range.length);
+    }
+    if (begin < size) visit(begin, size);
 }
 
-void extractTextSections(const fs::path& folderPath) {
-    for (const auto& entry : fs::directory_iterator(folderPath)) {
-        if (!entry.is_regular_file() || entry.path().extension() != TARGET_EXTENSION_EXE)
-            continue;
+// searchAllPatternOffsets over everything but `skipped`; matches may run into a skipped
+// range but not start in one.
+MatchSet searchKeptRanges(const uint8_t* data, size_t size, const BytePattern& pattern,
+                          const std::vector<TextRange>& skipped, bool* complete = nullptr) {
+    if (skipped.empty()) return searchAllPatternOffsets(data, size, pattern, complete);
 
-        const auto buffer = readFile(entry.path());
+    MatchSet matches;
+    if (complete) *complete = true;
+    forEachKeptRange(skipped, size, [&](size_t begin, size_t end) {
+        bool rangeComplete = true;
+        const size_t searchEnd = std::min(size, end + pattern.size() - 1);
+        for (size_t offset : searchAllPatternOffsets(data + begin, searchEnd - begin, pattern, &rangeComplete)) {
+            if (offset >= end - begin) break;
+            matches.push_back(begin + offset);
+        }
+        if (!rangeComplete && complete) *complete = false;
+    });
+    return matches;
+}
+
+// Corpus manifest: <folder>/.patternv-manifest keeps one line per build file with the
+// size and mtime it was indexed at, the game and build parsed from its name, its PE
+// section table and, once --skip-opaque has asked for them, the opaque ranges of its
+// .text. Entries whose size and mtime still match are trusted as-is, so a warm start
+// costs one small read plus a stat per build; new or changed files only have their PE
+// headers re-read.
+constexpr auto MANIFEST_FILENAME = ".patternv-manifest";
+constexpr auto MANIFEST_HEADER = "PatternV manifest 4";
+
+struct ManifestEntry {
+    std::string filename;
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    std::string gameName;
+    std::string build;
+    PeHeaders headers;
+    bool classified = false; // opaqueRanges is valid
+    std::vector<TextRange> opaqueRanges; // for the auto-detected layout
+};
+
+class CorpusManifest {
+public:
+    // Loads the folder's manifest, validates it against the files on disk and rewrites
+    // it if any entry had to be added, refreshed or dropped. Without `update`, stale
+    // entries are only refreshed in memory and nothing is classified or written.
+    void open(const fs::path& folderPath, bool update = true) {
+        std::error_code ec;
+        folder = fs::weakly_canonical(folderPath, ec);
+        if (ec) return;
+        const auto manifestPath = folder / MANIFEST_FILENAME;
+
+        std::unordered_map<std::string, ManifestEntry> stored;
+        std::ifstream file(manifestPath);
+        std::string line;
+        if (file && std::getline(file, line) && line == MANIFEST_HEADER) {
+            while (std::getline(file, line)) {
+                if (auto entry = parseEntry(line)) stored.emplace(entry->filename, std::move(*entry));
+            }
+        }
+
+        bool changed = false;
+        entries.clear();
+        for (const auto& path : listBuildFiles(folder)) {
+            const auto filename = path.filename().string();
+            const uint64_t size = fs::file_size(path, ec);
+            if (ec) continue;
+            const int64_t mtime = fs::last_write_time(path, ec).time_since_epoch().count();
+            if (ec) continue;
+
+            auto it = stored.find(filename);
+            if (it != stored.end() && it->second.size == size && it->second.mtime == mtime) {
+                entries.emplace(filename, std::move(it->second));
+                stored.erase(it);
+                continue;
+            }
+
+            if (auto entry = indexFile(path, size, mtime)) entries.emplace(filename, std::move(*entry));
+            changed = true;
+        }
+        changed |= !stored.empty();
+
+        // Classifying reads the whole .text, so it is only paid for once --skip-opaque
+        // actually needs the ranges; the result is cached like the rest of the entry.
+        if (skipOpaque && update) {
+            for (auto& [filename, entry] : entries) {
+                if (entry.classified) continue;
+                const auto text = findTextSection(entry.headers, entry.size);
+                if (!text) continue;
+                const auto buffer = readFileRange(folder / filename, text->rawOffset, text->rawSize);
+                if (buffer.size() != text->rawSize) continue;
+                entry.opaqueRanges = classifyOpaqueRegions(buffer.data(), buffer.size());
+                entry.classified = true;
+                changed = true;
+            }
+        }
+
+        if (changed && update) save(manifestPath);
+    }
+
+    const ManifestEntry* find(const fs::path& filePath) const {
+        if (entries.empty()) return nullptr;
+        std::error_code ec;
+        if (fs::weakly_canonical(filePath.parent_path(), ec) != folder || ec) return nullptr;
+        const auto it = entries.find(filePath.filename().string());
+        return it == entries.end() ? nullptr : &it->second;
+    }
+
+private:
+    static std::optional<ManifestEntry> indexFile(const fs::path& path, uint64_t size, int64_t mtime) {
+        ManifestEntry entry;
+        entry.filename = path.filename().string();
+        entry.size = size;
+        entry.mtime = mtime;
+        entry.gameName = extractGameName(entry.filename);
+        entry.build = extractBuildNumber(entry.filename).value_or(entry.filename);
+        if (path.extension() == TARGET_EXTENSION_TEXT) {
+            entry.headers.sections.push_back({ ".text", 0, static_cast<uint32_t>(size), 0, static_cast<uint32_t>(size) });
+        } else {
+            const auto header = readFileRange(path, 0, PE_HEADER_READ_SIZE);
+            if (header.empty()) return std::nullopt;
+            entry.headers = readPeHeaders(header);
+        }
+        return entry;
+    }
+
+    static std::optional<ManifestEntry> parseEntry(const std::string& line) {
+        std::vector<std::string> fields;
+        std::stringstream ss(line);
+        std::string field;
+        while (std::getline(ss, field, '\t')) fields.push_back(field);
+        if (fields.size() < 8) return std::nullopt;
+
+        try {
+            ManifestEntry entry;
+            entry.filename = fields[0];
+            entry.size = std::stoull(fields[1]);
+            entry.mtime = std::stoll(fields[2]);
+            entry.gameName = fields[3];
+            entry.build = fields[4];
+            entry.headers.imageBase = std::stoull(fields[5], nullptr, 16);
+            entry.headers.sizeOfImage = static_cast<uint32_t>(std::stoul(fields[6], nullptr, 16));
+            const size_t sectionCount = std::stoull(fields[7]);
+            const size_t rangesField = 8 + sectionCount * 5;
+            if (fields.size() <= rangesField) return std::nullopt;
+            for (size_t s = 0; s < sectionCount; ++s) {
+                const auto* f = &fields[8 + s * 5];
+                entry.headers.sections.push_back({ f[0], static_cast<uint32_t>(std::stoul(f[1], nullptr, 16)),
+                                           static_cast<uint32_t>(std::stoul(f[2], nullptr, 16)),
+                                           static_cast<uint32_t>(std::stoul(f[3], nullptr, 16)),
+                                           static_cast<uint32_t>(std::stoul(f[4], nullptr, 16)) });
+            }
+            if (fields[rangesField] == "-") {
+                if (fields.size() != rangesField + 1) return std::nullopt;
+                return entry;
+            }
+            const size_t rangeCount = std::stoull(fields[rangesField]);
+            if (fields.size() != rangesField + 1 + rangeCount * 2) return std::nullopt;
+            entry.classified = true;
+            for (size_t r = 0; r < rangeCount; ++r) {
+                const auto* f = &fields[rangesField + 1 + r * 2];
+                entry.opaqueRanges.push_back({ std::stoull(f[0], nullptr, 16), std::stoull(f[1], nullptr, 16) });
+            }
+            return entry;
+        } catch (...) {
+            return std::nullopt;
+        }
+    }
+
+    // Written to a uniquely named file next to the manifest and renamed over it, so that
+    // concurrent runs neither read a partial file nor write into each other's.
+    void save(const fs::path& manifestPath) const {
+        std::ostringstream suffix;
+        suffix << ".tmp." << std::hex << std::random_device{}() << std::random_device{}();
+        fs::path tempPath = manifestPath;
+        tempPath += suffix.str();
+        {
+            std::ofstream outFile(tempPath, std::ios::trunc);
+            if (!outFile) return;
+            outFile << MANIFEST_HEADER << '\n' << std::hex;
+            for (const auto& [filename, entry] : entries) {
+                outFile << filename << '\t' << std::dec << entry.size << '\t' << entry.mtime << '\t' << std::hex
+                        << entry.gameName << '\t' << entry.build << '\t'
+                        << entry.headers.imageBase << '\t' << entry.headers.sizeOfImage << '\t' << std::dec
+                        << entry.headers.sections.size() << std::hex;
+                for (const auto& section : entry.headers.sections) {
+                    outFile << '\t' << section.name << '\t' << section.virtualAddress << '\t' << section.virtualSize
+                            << '\t' << section.rawOffset << '\t' << section.rawSize;
+                }
+                if (!entry.classified) {
+                    outFile << "\t-\n";
+                    continue;
+                }
+                outFile << '\t' << std::dec << entry.opaqueRanges.size() << std::hex;
+                for (const auto& range : entry.opaqueRanges) outFile << '\t' << range.offset << '\t' << range.length;
+                outFile << '\n';
+            }
+        }
+        std::error_code ec;
+        fs::rename(tempPath, manifestPath, ec);
+        if (ec) fs::remove(tempPath, ec);
+    }
+
+    fs::path folder;
+    std::map<std::string, ManifestEntry> entries;
+};
+
+CorpusManifest buildManifest;
+
+// Opaque ranges of a build's .text as cached in the manifest, if it has them.
+std::optional<std::vector<TextRange>> cachedOpaqueRegions(const fs::path& filePath) {
+    const auto* entry = buildManifest.find(filePath);
+    if (entry && entry->classified && imageLayout == ImageLayout::Auto) return entry->opaqueRanges;
+    return std::nullopt;
+}
+
+// Opaque ranges of a build's .text: cached in the manifest, else classified on the spot.
+std::vector<TextRange> opaqueRegions(const fs::path& filePath, const uint8_t* text, size_t size) {
+    if (auto cached = cachedOpaqueRegions(filePath)) return std::move(*cached);
+    return classifyOpaqueRegions(text, size);
+}
+
+// What --skip-opaque leaves out of a loaded build; nothing when the flag is off.
+std::vector<TextRange> skippedRanges(const BuildImage& image) {
+    if (!skipOpaque) return {};
+    return opaqueRegions(image.path, image.text(), image.textSize);
+}
+
+bool insideRanges(const std::vector<TextRange>& ranges, size_t offset) {
+    auto it = std::upper_bound(ranges.begin(), ranges.end(), offset,
+                               [](size_t value, const TextRange& range) { return value < range.offset; });
+    return it != ranges.begin() && offset < std::prev(it)->offset + std::prev(it)->length;
+}
+
+std::optional<SectionInfo> locateTextSection(const fs::path& filePath) {
+    if (const auto* entry = buildManifest.find(filePath)) {
+        return findTextSection(entry->headers, entry->size);
+    }
+
+    std::error_code ec;
+    const size_t fileSize = fs::file_size(filePath, ec);
+    if (ec) return std::nullopt;
+
+    if (filePath.extension() == TARGET_EXTENSION_TEXT) {
+        return SectionInfo{ 0, fileSize };
+    }
+
+    return getTextSection(readFileRange(filePath, 0, PE_HEADER_READ_SIZE), fileSize);
+}
+
+std::optional<BuildImage> loadBuildImage(const fs::path& filePath) {
+    BuildImage image;
+    image.path = filePath;
+    image.filename = filePath.filename().string();
+
+    // A manifest entry already knows where .text is: read only that range.
+    if (const auto* entry = buildManifest.find(filePath)) {
+        if (const auto section = findTextSection(entry->headers, entry->size)) {
+            image.buffer = readFileRange(filePath, section->rawOffset, section->rawSize);
+            if (image.buffer.size() != section->rawSize) return std::nullopt;
+            image.textSize = section->rawSize;
+            image.textRva = section->virtualAddress;
+            image.imageBase = section->imageBase;
+            image.gameName = entry->gameName;
+            image.build = entry->build;
+            image.buildNumber = parseBuildNumber(image.build);
+            return image;
+        }
+    }
+
+    image.buffer = readFile(filePath);
+    if (image.buffer.empty()) return std::nullopt;
+
+    if (filePath.extension() == TARGET_EXTENSION_TEXT) {
+        image.textOffset = 0;
+        image.textSize = image.buffer.size();
+    } else {
+        auto textSection = getTextSection(image.buffer);
+        if (!textSection.has_value()) {
+            std::cerr << RED << "[-] .text section not found in: " << image.filename << RESET << '\n';
+            return std::nullopt;
+        }
+        image.textOffset = textSection->rawOffset;
+        image.textSize = textSection->rawSize;
+        image.textRva = textSection->virtualAddress;
+        image.imageBase = textSection->imageBase;
+    }
+
+    image.gameName = extractGameName(image.filename);
+    image.build = extractBuildNumber(image.filename).value_or(image.filename);
+    image.buildNumber = parseBuildNumber(image.build);
+    return image;
+}
+
+size_t countFixedBytes(const BytePattern& pattern) {
+    return static_cast<size_t>(std::count_if(pattern.begin(), pattern.end(),
+                                             [](const auto& b) { return b.has_value(); }));
+}
+
+// Samples random windows of .text from a few builds and extrapolates the number of
+// matches per build, with a 95% confidence interval over the per-window match rates.
+std::optional<MatchEstimate> estimateMatchCount(const std::vector<fs::path>& buildFiles,
+                                                const BytePattern& pattern)
+{
+    if (buildFiles.empty() || pattern.empty()) return std::nullopt;
+
+    std::mt19937_64 rng(std::random_device{}());
+    std::vector<double> rates;
+    double totalTextSize = 0;
+    size_t sampledBuilds = 0;
+    size_t sampledBytes = 0;
+
+    const size_t step = std::max<size_t>(1, buildFiles.size() / ESTIMATE_BUILDS);
+    for (size_t b = 0; b < buildFiles.size() && sampledBuilds < ESTIMATE_BUILDS; b += step) {
+        const auto section = locateTextSection(buildFiles[b]);
+        if (!section.has_value() || section->rawSize < pattern.size()) continue;
+
+        ++sampledBuilds;
+        totalTextSize += static_cast<double>(section->rawSize);
+
+        const size_t positions = section->rawSize - pattern.size() + 1;
+        const size_t window = std::min(ESTIMATE_WINDOW_SIZE, positions);
+        std::uniform_int_distribution<size_t> startDist(0, positions - window);
+
+        for (size_t w = 0; w < ESTIMATE_WINDOWS_PER_BUILD; ++w) {
+            const size_t start = startDist(rng);
+            const auto bytes = readFileRange(buildFiles[b], section->rawOffset + start, window + pattern.size() - 1);
+            if (bytes.size() < pattern.size()) continue;
+
+            bool complete = true;
+            const auto matches = searchAllPatternOffsets(bytes.data(), bytes.size(), pattern, &complete);
+            if (!complete) return std::nullopt;
+
+            rates.push_back(static_cast<double>(matches.size()) / static_cast<double>(bytes.size() - pattern.size() + 1));
+            sampledBytes += bytes.size();
+
+            if (window == positions) break; // the whole section fits in one window
+        }
+    }
+
+    if (rates.empty()) return std::nullopt;
+
+    double mean = 0;
+    for (double r : rates) mean += r;
+    mean /= static_cast<double>(rates.size());
+
+    double variance = 0;
+    for (double r : rates) variance += (r - mean) * (r - mean);
+    if (rates.size() > 1) variance /= static_cast<double>(rates.size() - 1);
+
+    const double averageSize = totalTextSize / static_cast<double>(sampledBuilds);
+    const double margin = 1.96 * std::sqrt(variance / static_cast<double>(rates.size()));
+    return MatchEstimate{
+        mean * averageSize,
+        std::max(0.0, mean - margin) * averageSize,
+        (mean + margin) * averageSize,
+        sampledBytes
+    };
+}
+
+bool reportSkippedIfInterrupted(const fs::path& filePath, std::mutex& outputMutex, std::vector<ResultLine>& outputBuffer)
+{
+    if (!scanInterrupted()) return false;
+
+    const auto filename = filePath.filename().string();
+    std::ostringstream oss;
+    oss << YELLOW << "[!]" << RESET << " Skipped " << filename << " (scan interrupted)";
+
+    std::lock_guard lock(outputMutex);
+    outputBuffer.push_back({ parseBuildNumber(extractBuildNumber(filename).value_or("0")), oss.str(), true });
+    return true;
+}
+
+// Symbol tables (--import-symbols, --symbols): a linker map or CSV symbol file is imported
+// once into `<build file>.syms`, an array of (RVA, name) records sorted by RVA followed
+// by the names. The table is memory-mapped and binary-searched only when matches are
+// printed with --symbols.
+constexpr char SYMS_MAGIC[8] = { 'P', 'V', 'S', 'Y', 'M', 'S', '\0', '\0' };
+constexpr uint32_t SYMS_VERSION = 1;
+constexpr auto SYMS_EXTENSION = ".syms";
+
+struct SymsHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t symbolCount;
+    uint64_t stringsOffset;
+    uint64_t stringsSize;
+};
+
+struct SymsRecord {
+    uint32_t rva;
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(SymsHeader) == 32);
+static_assert(sizeof(SymsRecord) == 16);
+
+class SymbolTable {
+public:
+    bool load(const fs::path& filePath) {
+        if (!file.open(filePath) || file.size() < sizeof(SymsHeader)) return false;
+
+        const auto* header = reinterpret_cast<const SymsHeader*>(file.data());
+        if (std::memcmp(header->magic, SYMS_MAGIC, sizeof(SYMS_MAGIC)) != 0 || header->version != SYMS_VERSION)
+            return false;
+
+        const uint64_t recordsEnd = sizeof(SymsHeader) + uint64_t(header->symbolCount) * sizeof(SymsRecord);
+        if (recordsEnd > header->stringsOffset || header->stringsOffset > file.size() ||
+            header->stringsSize > file.size() - header->stringsOffset)
+            return false;
+
+        records = reinterpret_cast<const SymsRecord*>(file.data() + sizeof(SymsHeader));
+        count = header->symbolCount;
+        strings = reinterpret_cast<const char*>(file.data() + header->stringsOffset);
+        for (size_t i = 0; i < count; ++i) {
+            if (uint64_t(records[i].nameOffset) + records[i].nameLength > header->stringsSize) return false;
+            if (i > 0 && records[i].rva < records[i - 1].rva) return false;
+        }
+        return true;
+    }
+
+    // Closest symbol at or below `rva`, with the distance from it.
+    std::optional<std::pair<std::string_view, uint32_t>> nearest(uint32_t rva) const {
+        const auto* it = std::upper_bound(records, records + count, rva,
+                                          [](uint32_t value, const SymsRecord& record) { return value < record.rva; });
+        if (it == records) return std::nullopt;
+        --it;
+        return std::make_pair(std::string_view(strings + it->nameOffset, it->nameLength), rva - it->rva);
+    }
+
+private:
+    MappedFile file;
+    const SymsRecord* records = nullptr;
+    size_t count = 0;
+    const char* strings = nullptr;
+};
+
+// Nothing unless --symbols is set. A raw .text dump has no section RVA to look its
+// offsets up with, so it is never annotated.
+std::optional<SymbolTable> loadBuildSymbols(const fs::path& buildPath) {
+    if (!annotateSymbols || buildPath.extension() == TARGET_EXTENSION_TEXT) return std::nullopt;
+
+    fs::path symsPath = buildPath;
+    symsPath += SYMS_EXTENSION;
+    if (!fs::exists(symsPath)) return std::nullopt;
+
+    SymbolTable symbols;
+    if (!symbols.load(symsPath)) {
+        std::cerr << RED << "[-] Corrupt or incompatible symbol table: " << symsPath << RESET << '\n';
+        return std::nullopt;
+    }
+    return symbols;
+}
+
+// `name+0x1C` for a .text offset, or nothing without a table or a symbol below it.
+std::string symbolName(const SymbolTable* symbols, uint32_t textRva, size_t offset) {
+    if (!symbols) return {};
+    const auto symbol = symbols->nearest(static_cast<uint32_t>(textRva + offset));
+    if (!symbol.has_value()) return {};
+
+    std::ostringstream oss;
+    oss << symbol->first;
+    if (symbol->second != 0) oss << "+0x" << std::hex << std::uppercase << symbol->second;
+    return oss.str();
+}
+
+// The same as ` <name+0x1C>`, appended to printed offsets.
+std::string symbolLabel(const SymbolTable* symbols, uint32_t textRva, size_t offset) {
+    const auto name = symbolName(symbols, textRva, offset);
+    return name.empty() ? name : " <" + name + ">";
+}
+
+// Accepts MSVC map lines (` 0001:00000010  name  0000000140001010 f  obj`, using the
+// Rva+Base column) and CSV lines `address,name` or `name,address`. Addresses at or above
+// the image base are taken as VAs, lower ones as RVAs; other lines are skipped. A map's
+// "Preferred load address" is its base, since a dumped build may have been rebased.
+bool importSymbols(const fs::path& inputPath, const fs::path& buildPath) {
+    if (buildPath.extension() == TARGET_EXTENSION_TEXT) {
+        std::cerr << RED << "[-] A .text dump has no RVAs to attach symbols to: " << buildPath << RESET << '\n';
+        return false;
+    }
+
+    std::ifstream file(inputPath);
+    if (!file) {
+        std::cerr << RED << "[-] Failed to open: " << inputPath << RESET << '\n';
+        return false;
+    }
+
+    const auto section = locateTextSection(buildPath);
+    uint64_t imageBase = section.has_value() ? section->imageBase : 0;
+
+    auto parseAddress = [](std::string text) -> std::optional<uint64_t> {
+        if (text.starts_with("0x") || text.starts_with("0X")) text = text.substr(2);
+        if (text.empty() || text.size() > 16 || !std::all_of(text.begin(), text.end(), [](unsigned char c) { return std::isxdigit(c); }))
+            return std::nullopt;
+        return std::stoull(text, nullptr, 16);
+    };
+    auto trim = [](const std::string& str) {
+        const size_t first = str.find_first_not_of(" \t\r\"");
+        if (first == std::string::npos) return std::string();
+        return str.substr(first, str.find_last_not_of(" \t\r\"") - first + 1);
+    };
+    static const std::regex mapLine(R"(^\s*[0-9A-Fa-f]{4}:[0-9A-Fa-f]{8}\s+(\S+)\s+([0-9A-Fa-f]{8,16})\b)");
+    static const std::regex loadAddressLine(R"(Preferred load address is\s+([0-9A-Fa-f]{1,16})\b)");
+
+    std::vector<std::pair<uint64_t, std::string>> symbols;
+    size_t outOfRange = 0;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::optional<uint64_t> address;
+        std::string name;
+
+        std::smatch match;
+        if (std::regex_search(line, match, loadAddressLine)) {
+            imageBase = parseAddress(match[1]).value_or(imageBase);
+            continue;
+        }
+        if (std::regex_search(line, match, mapLine)) {
+            name = match[1];
+            address = parseAddress(match[2]);
+        } else if (const size_t comma = line.find(','); comma != std::string::npos) {
+            const auto first = trim(line.substr(0, comma));
+            const auto rest = line.substr(comma + 1);
+            const auto second = trim(rest.substr(0, rest.find(',')));
+            if ((address = parseAddress(first))) name = second;
+            else if ((address = parseAddress(second))) name = first;
+        }
+        if (!address.has_value() || name.empty()) continue;
+
+        const uint64_t rva = imageBase != 0 && *address >= imageBase ? *address - imageBase : *address;
+        if (rva > std::numeric_limits<uint32_t>::max()) {
+            ++outOfRange;
+            continue;
+        }
+        symbols.emplace_back(rva, std::move(name));
+    }
+    if (outOfRange > 0) {
+        std::cerr << YELLOW << "[!]" << RESET << " Skipped " << outOfRange
+                  << " symbols more than 4 GB past the image base 0x" << std::hex << std::uppercase << imageBase
+                  << std::dec << '\n';
+    }
+
+    if (symbols.empty()) {
+        std::cerr << RED << "[-] No symbols in: " << inputPath << RESET << '\n';
+        return false;
+    }
+    std::stable_sort(symbols.begin(), symbols.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    SymsHeader header{};
+    std::memcpy(header.magic, SYMS_MAGIC, sizeof(SYMS_MAGIC));
+    header.version = SYMS_VERSION;
+    header.symbolCount = static_cast<uint32_t>(symbols.size());
+    header.stringsOffset = sizeof(SymsHeader) + symbols.size() * sizeof(SymsRecord);
+
+    std::vector<SymsRecord> records;
+    std::string strings;
+    for (const auto& [rva, name] : symbols) {
+        records.push_back({ static_cast<uint32_t>(rva), static_cast<uint32_t>(strings.size()),
+                            static_cast<uint32_t>(name.size()), 0 });
+        strings += name;
+    }
+    header.stringsSize = strings.size();
+
+    fs::path outputPath = buildPath;
+    outputPath += SYMS_EXTENSION;
+    std::ofstream outFile(outputPath, std::ios::binary);
+    if (!outFile) {
+        std::cerr << RED << "[-] Failed to create: " << outputPath << RESET << '\n';
+        return false;
+    }
+    outFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    outFile.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(SymsRecord)));
+    outFile.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+
+    std::cout << GREEN << "[+]" << RESET << " Imported " << symbols.size() << " symbols -> " << outputPath.string() << '\n';
+    return true;
+}
+
+std::string formatPatternResult(const std::string& gameName, const std::string& build, const MatchSet& matches,
+                                bool countOnly, bool complete, const SymbolTable* symbols = nullptr,
+                                uint32_t textRva = 0)
+{
+    std::ostringstream oss;
+    if (!matches.empty()) {
+        if (minifiedOutput) {
+            oss << GREEN << "[+] " << RESET << gameName << "_" << build << " (" << matches.size() << " matches)";
+            if (!countOnly) {
+                oss << ": ";
+                bool first = true;
+                for (size_t offset : matches) {
+                    if (!first)
+                        oss << ", ";
+                    oss << "0x" << std::hex << std::uppercase << offset << symbolLabel(symbols, textRva, offset);
+                    first = false;
+                }
+            }
+        } else {
+            oss << GREEN << "[+]" << RESET << " Pattern found in " << gameName << " v" << YELLOW << build
+                << RESET << " (" << matches.size() << " matches)";
+            if (!countOnly) {
+                oss << ": ";
+                bool first = true;
+                for (size_t offset : matches) {
+                    if (!first)
+                        oss << ", ";
+                    oss << YELLOW << "0x" << std::hex << std::uppercase << offset << RESET
+                        << symbolLabel(symbols, textRva, offset);
+                    first = false;
+                }
+            }
+        }
+    } else {
+        if (minifiedOutput) {
+            oss << RED << "[-] " << RESET << gameName << "_" << build << " (0 matches)";
+        } else {
+            oss << RED << "[-]" << RESET << " Pattern not found in " << gameName << " v" << YELLOW << build << RESET;
+        }
+    }
+
+    if (!complete) {
+        oss << YELLOW << " (incomplete)" << RESET;
+    }
+
+    return oss.str();
+}
+
+// Locality-guided scanning: consecutive builds usually keep a match at roughly the same
+// relative position, so each build first searches small windows around the offsets
+// predicted from the previously scanned build and only reads those windows from disk.
+// Builds are split into contiguous groups scanned in parallel; each group starts with a
+// full scan and a build falls back to one whenever a predicted window comes up empty.
+std::optional<MatchSet> searchNearPredictions(const fs::path& filePath, const SectionInfo& section,
+                                              const BytePattern& pattern, const std::vector<size_t>& previousMatches,
+                                              size_t previousSize, bool* complete, size_t& bytesRead)
+{
+    struct Window {
+        size_t begin;
+        size_t end;
+        size_t expected;
+    };
+    std::vector<Window> windows;
+    for (size_t offset : previousMatches) {
+        const size_t predicted = static_cast<size_t>(static_cast<double>(offset) / static_cast<double>(previousSize) *
+                                                     static_cast<double>(section.rawSize));
+        const size_t begin = predicted > localityWindow ? predicted - localityWindow : 0;
+        const size_t end = std::min(section.rawSize, predicted + localityWindow + pattern.size());
+        if (begin >= end) return std::nullopt;
+
+        if (!windows.empty() && begin <= windows.back().end) {
+            windows.back().end = std::max(windows.back().end, end);
+            ++windows.back().expected;
+        } else {
+            windows.push_back({ begin, end, 1 });
+        }
+    }
+
+    std::vector<size_t> found;
+    for (const auto& window : windows) {
+        const auto bytes = readFileRange(filePath, section.rawOffset + window.begin, window.end - window.begin);
+        bytesRead += bytes.size();
+
+        bool windowComplete = true;
+        const auto matches = searchAllPatternOffsets(bytes.data(), bytes.size(), pattern, &windowComplete);
+        *complete &= windowComplete;
+        if (matches.size() < window.expected) return std::nullopt;
+
+        for (size_t offset : matches) found.push_back(window.begin + offset);
+    }
+
+    MatchSet matches;
+    for (size_t offset : found) matches.push_back(offset);
+    return matches;
+}
+
+void scanBuildGroupLocal(const std::vector<fs::path>& group, const BytePattern& pattern, bool countOnly,
+                         std::atomic<size_t>& localBuilds, std::atomic<size_t>& totalBytesRead,
+                         std::mutex& outputMutex, std::vector<ResultLine>& outputBuffer)
+{
+    std::vector<size_t> previousMatches;
+    size_t previousSize = 0;
+
+    for (const auto& path : group) {
+        if (reportSkippedIfInterrupted(path, outputMutex, outputBuffer)) continue;
+
+        sem.acquire();
+        const auto section = locateTextSection(path);
+        if (!section.has_value()) {
+            sem.release();
+            std::cerr << RED << "[-] .text section not found in: " << path.filename().string() << RESET << '\n';
+            continue;
+        }
+
+        bool complete = true;
+        size_t bytesRead = PE_HEADER_READ_SIZE;
+        std::optional<MatchSet> matches;
+        bool local = false;
+        // Predicted windows can only honour --skip-opaque when the ranges are cached;
+        // otherwise classifying would read the whole .text anyway.
+        const std::optional<std::vector<TextRange>> skipped =
+            skipOpaque ? cachedOpaqueRegions(path) : std::vector<TextRange>{};
+        if (!previousMatches.empty() && skipped.has_value()) {
+            matches = searchNearPredictions(path, *section, pattern, previousMatches, previousSize, &complete, bytesRead);
+            if (matches.has_value() && !skipped->empty()) {
+                MatchSet kept;
+                for (size_t offset : *matches) {
+                    if (!insideRanges(*skipped, offset)) kept.push_back(offset);
+                }
+                matches = std::move(kept);
+            }
+            local = matches.has_value() && !(proveUnique && matches->size() == 1);
+        }
+
+        if (!local) {
+            complete = true;
+            const auto image = loadBuildImage(path);
+            if (!image.has_value()) {
+                sem.release();
+                continue;
+            }
+            matches = searchKeptRanges(image->text(), image->textSize, pattern, skipped ? *skipped : skippedRanges(*image),
+                                       &complete);
+            bytesRead += image->buffer.size();
+        }
+        sem.release();
+
+        totalBytesRead += bytesRead;
+        if (local) ++localBuilds;
+
+        const auto filename = path.filename().string();
+        const auto build = extractBuildNumber(filename).value_or(filename);
+        const auto symbols = loadBuildSymbols(path);
+        std::string line = formatPatternResult(extractGameName(filename), build, *matches, countOnly, complete,
+                                               symbols ? &*symbols : nullptr, section->virtualAddress);
+        if (local) line += std::string(YELLOW) + " (local)" + RESET;
+
+        {
+            std::lock_guard lock(outputMutex);
+            outputBuffer.push_back({ parseBuildNumber(build), line, !complete });
+        }
+
+        previousMatches.assign(matches->begin(), matches->end());
+        previousSize = section->rawSize;
+    }
+}
+
+// Bounded queue between two pipeline stages: producers block while it is full, and
+// consumers drain it until every producer has closed it.
+template <typename T>
+class BoundedChannel {
+public:
+    explicit BoundedChannel(size_t capacity, size_t producers = 1) : capacity(capacity), openProducers(producers) {}
+
+    void push(T value) {
+        std::unique_lock lock(mutex);
+        notFull.wait(lock, [this] { return items.size() < capacity; });
+        items.push_back(std::move(value));
+        notEmpty.notify_one();
+    }
+
+    std::optional<T> pop() {
+        std::unique_lock lock(mutex);
+        notEmpty.wait(lock, [this] { return !items.empty() || openProducers == 0; });
+        if (items.empty()) return std::nullopt;
+
+        T value = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return value;
+    }
+
+    void close() {
+        std::lock_guard lock(mutex);
+        if (openProducers > 0 && --openProducers == 0) notEmpty.notify_all();
+    }
+
+private:
+    std::deque<T> items;
+    size_t capacity;
+    size_t openProducers;
+    std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+};
+
+// One build on its way through the scan pipeline. `done` items (unreadable, or skipped
+// after an interruption) pass through the remaining stages untouched.
+struct PipelineItem {
+    size_t sequence = 0;
+    fs::path path;
+    SectionInfo section{};
+    std::vector<uint8_t> text;
+    ResultLine result{};
+    bool found = false;
+    bool done = false;
+};
+
+// Runs `stage` on `workers` threads between two channels; the output channel must have
+// been created with one producer per worker.
+template <typename Stage>
+std::vector<std::thread> startStage(size_t workers, BoundedChannel<PipelineItem>& input,
+                                    BoundedChannel<PipelineItem>& output, Stage stage)
+{
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < workers; ++i) {
+        threads.emplace_back([&input, &output, stage] {
+            while (auto item = input.pop()) {
+                if (!item->done) stage(*item);
+                output.push(std::move(*item));
+            }
+            output.close();
+        });
+    }
+    return threads;
+}
+
+// Scan pipeline: enumerate -> parse (PE headers only) -> load (.text only) -> scan ->
+// format, with bounded channels between stages so that reading, parsing and searching
+// overlap and at most a few sections are held in memory. Results are printed in build
+// order as soon as every earlier build is done.
+std::pair<bool, bool> scanPipeline(std::vector<fs::path> buildFiles, const BytePattern& pattern, bool countOnly) {
+    std::sort(buildFiles.begin(), buildFiles.end(), [](const fs::path& a, const fs::path& b) {
+        return parseBuildNumber(extractBuildNumber(a.filename().string()).value_or("0")) <
+               parseBuildNumber(extractBuildNumber(b.filename().string()).value_or("0"));
+    });
+
+    const size_t scanWorkers = std::max<size_t>(1, std::thread::hardware_concurrency());
+    BoundedChannel<PipelineItem> paths(PIPELINE_QUEUE_DEPTH);
+    BoundedChannel<PipelineItem> sections(PIPELINE_QUEUE_DEPTH, PIPELINE_PARSE_WORKERS);
+    BoundedChannel<PipelineItem> loaded(scanWorkers, PIPELINE_LOAD_WORKERS);
+    BoundedChannel<PipelineItem> results(PIPELINE_QUEUE_DEPTH, scanWorkers);
+
+    auto skipIfInterrupted = [](PipelineItem& item) {
+        if (!scanInterrupted()) return false;
+        const auto filename = item.path.filename().string();
+        item.result = { parseBuildNumber(extractBuildNumber(filename).value_or("0")),
+                        std::string(YELLOW) + "[!]" + RESET + " Skipped " + filename + " (scan interrupted)", true };
+        item.done = true;
+        return true;
+    };
+
+    std::vector<std::thread> threads;
+    threads.emplace_back([&] {
+        for (size_t i = 0; i < buildFiles.size(); ++i) {
+            PipelineItem item;
+            item.sequence = i;
+            item.path = buildFiles[i];
+            paths.push(std::move(item));
+        }
+        paths.close();
+    });
+
+    auto parse = startStage(PIPELINE_PARSE_WORKERS, paths, sections, [&](PipelineItem& item) {
+        if (skipIfInterrupted(item)) return;
+        const auto section = locateTextSection(item.path);
+        if (!section.has_value()) {
+            std::cerr << RED << "[-] .text section not found in: " << item.path.filename().string() << RESET << '\n';
+            item.done = true;
+            return;
+        }
+        item.section = *section;
+    });
+
+    auto load = startStage(PIPELINE_LOAD_WORKERS, sections, loaded, [&](PipelineItem& item) {
+        if (skipIfInterrupted(item)) return;
+        item.text = readFileRange(item.path, item.section.rawOffset, item.section.rawSize);
+        if (item.text.size() != item.section.rawSize) item.done = true;
+    });
+
+    auto scan = startStage(scanWorkers, loaded, results, [&](PipelineItem& item) {
+        if (skipIfInterrupted(item)) return;
+        const auto filename = item.path.filename().string();
+        const auto build = extractBuildNumber(filename).value_or(filename);
+
+        bool complete = true;
+        const auto skipped = skipOpaque ? opaqueRegions(item.path, item.text.data(), item.text.size()) : std::vector<TextRange>{};
+        const auto matches = searchKeptRanges(item.text.data(), item.text.size(), pattern, skipped, &complete);
+        const auto symbols = loadBuildSymbols(item.path);
+        item.result = { parseBuildNumber(build),
+                        formatPatternResult(extractGameName(filename), build, matches, countOnly, complete,
+                                            symbols ? &*symbols : nullptr, item.section.virtualAddress),
+                        !complete };
+        item.found = !matches.empty();
+        item.text = {};
+    });
+
+    for (auto* stage : { &parse, &load, &scan }) {
+        std::move(stage->begin(), stage->end(), std::back_inserter(threads));
+    }
+
+    // Format stage: reorder by sequence and print every result whose predecessors are out.
+    bool allFound = true;
+    bool anyIncomplete = false;
+    std::map<size_t, PipelineItem> pending;
+    size_t nextSequence = 0;
+    while (auto item = results.pop()) {
+        pending.emplace(item->sequence, std::move(*item));
+        for (auto it = pending.begin(); it != pending.end() && it->first == nextSequence; it = pending.erase(it)) {
+            const auto& ready = it->second;
+            ++nextSequence;
+            if (ready.result.line.empty()) continue;
+
+            std::cout << ready.result.line << std::endl;
+            allFound &= ready.found;
+            anyIncomplete |= ready.result.incomplete;
+        }
+    }
+
+    for (auto& thread : threads) thread.join();
+    return { allFound, anyIncomplete };
+}
+
+bool scanDirectory(const fs::path& folderPath, const BytePattern& pattern) {
+    using namespace std::chrono;
+    const auto start = high_resolution_clock::now();
+    beginScan();
+
+    std::vector<ResultLine> outputBuffer;
+    std::mutex outputMutex;
+    std::vector<std::future<void>> futures;
+
+    const auto buildFiles = listBuildFiles(folderPath);
+
+    bool countOnly = countOnlyOutput;
+    if (!countOnly && estimateThreshold > 0 && countFixedBytes(pattern) < ESTIMATE_MAX_FIXED_BYTES) {
+        const auto estimate = estimateMatchCount(buildFiles, pattern);
+        if (estimate.has_value() && estimate->perBuild > static_cast<double>(estimateThreshold)) {
+            std::cout << YELLOW << "[!]" << RESET << " Generic pattern: ~" << static_cast<size_t>(estimate->perBuild)
+                      << " matches per build expected (95% CI " << static_cast<size_t>(estimate->low) << "-"
+                      << static_cast<size_t>(estimate->high) << ", sampled " << estimate->sampledBytes / 1024 << " KB)\n";
+
+            if (interactiveMode) {
+                endScan();
+                std::cout << "    Continue? [y]es / [n]o / [c]ount only: ";
+                std::string answer;
+                std::getline(std::cin, answer);
+
+                if (answer == "c" || answer == "C") {
+                    countOnly = true;
+                } else if (answer != "y" && answer != "Y") {
+                    return false;
+                }
+                beginScan();
+            } else {
+                std::cout << "    Switching to count-only output.\n";
+                countOnly = true;
+            }
+        }
+    }
+
+    std::atomic<size_t> localBuilds{ 0 };
+    std::atomic<size_t> bytesRead{ 0 };
+    std::vector<std::vector<fs::path>> groups;
+    if (localitySearch) {
+        // Matches only predict the next build of the same game, so each game's builds are
+        // chunked into groups of their own.
+        auto sorted = buildFiles;
+        std::sort(sorted.begin(), sorted.end(), [](const fs::path& a, const fs::path& b) {
+            const auto nameA = a.filename().string();
+            const auto nameB = b.filename().string();
+            const auto gameA = extractGameName(nameA);
+            const auto gameB = extractGameName(nameB);
+            if (gameA != gameB) return gameA < gameB;
+            return parseBuildNumber(extractBuildNumber(nameA).value_or("0")) <
+                   parseBuildNumber(extractBuildNumber(nameB).value_or("0"));
+        });
+
+        const size_t groupCount = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), sorted.size()));
+        const size_t groupSize = (sorted.size() + groupCount - 1) / std::max<size_t>(1, groupCount);
+        for (size_t runBegin = 0; runBegin < sorted.size();) {
+            const auto game = extractGameName(sorted[runBegin].filename().string());
+            size_t runEnd = runBegin + 1;
+            while (runEnd < sorted.size() && extractGameName(sorted[runEnd].filename().string()) == game) ++runEnd;
+
+            for (size_t begin = runBegin; begin < runEnd; begin += groupSize) {
+                groups.emplace_back(sorted.begin() + begin, sorted.begin() + std::min(runEnd, begin + groupSize));
+            }
+            runBegin = runEnd;
+        }
+
+        for (const auto& group : groups) {
+            futures.push_back(std::async(std::launch::async, scanBuildGroupLocal,
+                                         std::cref(group), std::cref(pattern), countOnly,
+                                         std::ref(localBuilds), std::ref(bytesRead),
+                                         std::ref(outputMutex), std::ref(outputBuffer)));
+        }
+    }
+
+    bool allFound = true;
+    bool anyIncomplete = false;
+    if (localitySearch) {
+        for (auto& f : futures) f.get();
+        endScan();
+
+        std::lock_guard lock(outputMutex);
+        std::sort(outputBuffer.begin(), outputBuffer.end(),
+                  [](const ResultLine& a, const ResultLine& b) {
+                      return a.build < b.build;
+                  });
+
+        for (const auto& result : outputBuffer) {
+            std::cout << result.line << '\n';
+            if (result.line.find("Pattern not found") != std::string::npos) {
+                allFound = false;
+            }
+            if (result.incomplete) {
+                anyIncomplete = true;
+            }
+        }
+    } else {
+        std::tie(allFound, anyIncomplete) = scanPipeline(buildFiles, pattern, countOnly);
+        endScan();
+    }
+
+    if (anyIncomplete) {
+        allFound = false;
+        if (scanTimedOut.load()) {
+            std::cout << YELLOW << "[!]" << RESET << " Query timed out after " << queryTimeout.count()
+                      << " ms, results are partial\n";
+        } else {
+            std::cout << YELLOW << "[!]" << RESET << " Scan cancelled, results are partial\n";
+        }
+    }
+
+    if (localitySearch) {
+        std::cout << "\n[~] " << localBuilds.load() << "/" << buildFiles.size()
+                  << " builds resolved from neighbouring matches, read " << bytesRead.load() / 1024 << " KB";
+    }
+
+    const auto end = high_resolution_clock::now();
+    if (!hideTime) {
+        std::cout << "\n[~] Scan completed in "
+                << duration_cast<milliseconds>(end - start).count()
+                << " ms\n";
+    } else if (localitySearch) {
+        std::cout << '\n';
+    }
+
+    return allFound;
+}
+
+// Signature sets: a text file with one `name = pattern  # note` per line, compiled into a
+// flat database image (see SigDbHeader) that can also be saved and memory-mapped as is.
+// Every signature is indexed by a two-byte anchor in a 65536-bucket table, so a single
+// pass over .text feeds all signatures at once. `name = a | b | c` declares a fallback
+// chain: all alternatives are scanned together and the first one, in order, that matches
+// uniquely wins for each build.
+constexpr char SIGDB_MAGIC[8] = { 'P', 'V', 'S', 'I', 'G', 'D', 'B', '\0' };
+constexpr uint32_t SIGDB_VERSION = 3;
+constexpr uint32_t SIGDB_BUCKET_COUNT = 0x10000;
+
+struct SigDbHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t signatureCount;
+    uint32_t entryCount;
+    uint32_t captureCount;
+    uint64_t signaturesOffset;
+    uint64_t bucketsOffset;
+    uint64_t entriesOffset;
+    uint64_t bytesOffset;
+    uint64_t bytesSize;
+    uint64_t stringsOffset;
+    uint64_t stringsSize;
+    uint64_t capturesOffset;
+};
+
+struct SigDbSignature {
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint32_t noteOffset;
+    uint32_t noteLength;
+    uint32_t patternOffset; // `length` masked value bytes followed by `length` mask bytes
+    uint32_t length;
+    uint32_t anchorOffset;
+    uint32_t fixedBytes;
+    uint32_t alternative;  // priority within its fallback chain, 0 = primary
+    uint32_t alternatives; // chain length; the members of a chain are consecutive records
+    uint32_t firstCapture;
+    uint32_t captureCount;
+};
+
+struct SigDbCapture {
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint32_t offset; // within the pattern
+    CaptureType type;
+};
+
+struct SigDbEntry {
+    uint32_t signature;
+    uint32_t anchorOffset;
+};
+
+static_assert(sizeof(SigDbHeader) == 88);
+static_assert(sizeof(SigDbSignature) == 48);
+static_assert(sizeof(SigDbEntry) == 8);
+static_assert(sizeof(SigDbCapture) == 16);
+
+struct SignatureSource {
+    std::string name;
+    std::string note;
+    BytePattern pattern;
+    uint32_t alternative = 0;
+    uint32_t alternatives = 1;
+    std::vector<Capture> captures = {};
+};
+
+std::vector<SignatureSource> parseSignatureFile(const fs::path& filePath) {
+    std::vector<SignatureSource> signatures;
+    std::ifstream file(filePath);
+    if (!file) {
+        std::cerr << RED << "[-] Failed to open signature file: " << filePath << RESET << '\n';
+        return signatures;
+    }
+
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+
+        std::string note;
+        const size_t hashPos = line.find('#');
+        if (hashPos != std::string::npos) {
+            note = line.substr(hashPos + 1);
+            line.resize(hashPos);
+        }
+
+        const size_t eqPos = line.find('=');
+        if (eqPos == std::string::npos) {
+            if (line.find_first_not_of(" \t\r") != std::string::npos) {
+                std::cerr << RED << "[-] " << filePath.filename().string() << ":" << lineNumber
+                          << ": expected `name = pattern`" << RESET << '\n';
+            }
+            continue;
+        }
+
+        auto trim = [](std::string str) {
+            const size_t first = str.find_first_not_of(" \t\r");
+            if (first == std::string::npos) return std::string();
+            const size_t last = str.find_last_not_of(" \t\r");
+            return str.substr(first, last - first + 1);
+        };
+
+        std::vector<SignatureSource> chain;
+        const std::string name = trim(line.substr(0, eqPos));
+        std::stringstream alternatives(line.substr(eqPos + 1));
+        std::string alternative;
+        bool valid = !name.empty();
+        while (valid && std::getline(alternatives, alternative, '|')) {
+            SignatureSource signature{ name, trim(note), {}, static_cast<uint32_t>(chain.size()) };
+            signature.pattern = parseBytePattern(alternative, &signature.captures);
+            valid = countFixedBytes(signature.pattern) > 0;
+            chain.push_back(std::move(signature));
+        }
+        if (!valid || chain.empty()) {
+            std::cerr << RED << "[-] " << filePath.filename().string() << ":" << lineNumber
+                      << ": invalid signature" << RESET << '\n';
+            continue;
+        }
+
+        for (auto& signature : chain) {
+            signature.alternatives = static_cast<uint32_t>(chain.size());
+            signatures.push_back(std::move(signature));
+        }
+    }
+
+    return signatures;
+}
+
+// Picks the consecutive pair of fixed bytes least likely to occur in code. Returns the
+// offset of the pair, or of the single rarest fixed byte when no pair exists.
+std::pair<size_t, bool> chooseAnchor(const BytePattern& pattern) {
+    size_t bestOffset = 0;
+    int bestScore = std::numeric_limits<int>::max();
+    bool paired = false;
+
+    for (size_t j = 0; j + 1 < pattern.size(); ++j) {
+        if (!pattern[j].has_value() || !pattern[j + 1].has_value()) continue;
+        const int score = byteCommonness(*pattern[j]) + byteCommonness(*pattern[j + 1]);
+        if (score < bestScore) {
+            bestScore = score;
+            bestOffset = j;
+            paired = true;
+        }
+    }
+
+    if (paired) return { bestOffset, true };
+
+    for (size_t j = 0; j < pattern.size(); ++j) {
+        if (!pattern[j].has_value()) continue;
+        const int score = byteCommonness(*pattern[j]);
+        if (score < bestScore) {
+            bestScore = score;
+            bestOffset = j;
+        }
+    }
+
+    return { bestOffset, false };
+}
+
+std::vector<uint8_t> compileSignatureDatabase(const std::vector<SignatureSource>& signatures) {
+    std::vector<SigDbSignature> records;
+    std::vector<SigDbCapture> captures;
+    std::vector<uint8_t> bytes;
+    std::string strings;
+    std::vector<std::vector<SigDbEntry>> buckets(SIGDB_BUCKET_COUNT);
+
+    for (uint32_t id = 0; id < signatures.size(); ++id) {
+        const auto& source = signatures[id];
+        const auto [anchor, paired] = chooseAnchor(source.pattern);
+
+        SigDbSignature record{};
+        record.nameOffset = static_cast<uint32_t>(strings.size());
+        record.nameLength = static_cast<uint32_t>(source.name.size());
+        strings += source.name;
+        record.noteOffset = static_cast<uint32_t>(strings.size());
+        record.noteLength = static_cast<uint32_t>(source.note.size());
+        strings += source.note;
+        record.patternOffset = static_cast<uint32_t>(bytes.size());
+        record.length = static_cast<uint32_t>(source.pattern.size());
+        record.anchorOffset = static_cast<uint32_t>(anchor);
+        record.fixedBytes = static_cast<uint32_t>(countFixedBytes(source.pattern));
+        record.alternative = source.alternative;
+        record.alternatives = source.alternatives;
+        record.firstCapture = static_cast<uint32_t>(captures.size());
+        record.captureCount = static_cast<uint32_t>(source.captures.size());
+        for (const auto& capture : source.captures) {
+            captures.push_back({ static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(capture.name.size()),
+                                 static_cast<uint32_t>(capture.offset), capture.type });
+            strings += capture.name;
+        }
+
+        for (const auto& b : source.pattern) bytes.push_back(b.value_or(0x00));
+        for (const auto& b : source.pattern) bytes.push_back(b.has_value() ? 0xFF : 0x00);
+        records.push_back(record);
+
+        const uint8_t first = *source.pattern[anchor];
+        if (paired) {
+            const uint8_t second = *source.pattern[anchor + 1];
+            buckets[first | (second << 8)].push_back({ id, record.anchorOffset });
+        } else {
+            for (uint32_t second = 0; second < 0x100; ++second) {
+                buckets[first | (second << 8)].push_back({ id, record.anchorOffset });
+            }
+        }
+    }
+
+    auto align8 = [](size_t value) { return (value + 7) & ~size_t(7); };
+
+    SigDbHeader header{};
+    std::memcpy(header.magic, SIGDB_MAGIC, sizeof(SIGDB_MAGIC));
+    header.version = SIGDB_VERSION;
+    header.signatureCount = static_cast<uint32_t>(records.size());
+    header.captureCount = static_cast<uint32_t>(captures.size());
+    for (const auto& bucket : buckets) header.entryCount += static_cast<uint32_t>(bucket.size());
+
+    header.signaturesOffset = align8(sizeof(SigDbHeader));
+    header.bucketsOffset = align8(header.signaturesOffset + records.size() * sizeof(SigDbSignature));
+    header.entriesOffset = align8(header.bucketsOffset + (SIGDB_BUCKET_COUNT + 1) * sizeof(uint32_t));
+    header.bytesOffset = align8(header.entriesOffset + header.entryCount * sizeof(SigDbEntry));
+    header.bytesSize = bytes.size();
+    header.stringsOffset = align8(header.bytesOffset + bytes.size());
+    header.stringsSize = strings.size();
+    header.capturesOffset = align8(header.stringsOffset + strings.size());
+
+    std::vector<uint8_t> image(header.capturesOffset + captures.size() * sizeof(SigDbCapture));
+    std::memcpy(image.data(), &header, sizeof(header));
+    if (!records.empty()) {
+        std::memcpy(image.data() + header.signaturesOffset, records.data(), records.size() * sizeof(SigDbSignature));
+    }
+
+    auto* bucketStarts = reinterpret_cast<uint32_t*>(image.data() + header.bucketsOffset);
+    auto* entries = reinterpret_cast<SigDbEntry*>(image.data() + header.entriesOffset);
+    uint32_t entryIndex = 0;
+    for (uint32_t key = 0; key < SIGDB_BUCKET_COUNT; ++key) {
+        bucketStarts[key] = entryIndex;
+        for (const auto& entry : buckets[key]) entries[entryIndex++] = entry;
+    }
+    bucketStarts[SIGDB_BUCKET_COUNT] = entryIndex;
+
+    if (!bytes.empty()) std::memcpy(image.data() + header.bytesOffset, bytes.data(), bytes.size());
+    if (!strings.empty()) std::memcpy(image.data() + header.stringsOffset, strings.data(), strings.size());
+    if (!captures.empty()) {
+        std::memcpy(image.data() + header.capturesOffset, captures.data(), captures.size() * sizeof(SigDbCapture));
+    }
+    return image;
+}
+
+// View over a compiled signature database, either built in memory from a text file or
+// memory-mapped from a file written by --compile-sigs.
+class SignatureDatabase {
+public:
+    bool loadImage(std::vector<uint8_t> image) {
+        ownedImage = std::move(image);
+        return attach(ownedImage.data(), ownedImage.size());
+    }
+
+    bool loadMapped(MappedFile file) {
+        mappedFile = std::move(file);
+        return attach(mappedFile.data(), mappedFile.size());
+    }
+
+    size_t size() const { return header->signatureCount; }
+    size_t chainCount() const {
+        size_t count = 0;
+        for (uint32_t i = 0; i < header->signatureCount; ++i) count += signatures[i].alternative == 0;
+        return count;
+    }
+    const SigDbSignature& signature(size_t id) const { return signatures[id]; }
+    std::string_view name(size_t id) const { return { strings + signatures[id].nameOffset, signatures[id].nameLength }; }
+    std::string_view note(size_t id) const { return { strings + signatures[id].noteOffset, signatures[id].noteLength }; }
+    const uint8_t* value(size_t id) const { return bytes + signatures[id].patternOffset; }
+    const uint8_t* mask(size_t id) const { return bytes + signatures[id].patternOffset + signatures[id].length; }
+    std::vector<Capture> captures(size_t id) const {
+        std::vector<Capture> result;
+        for (uint32_t c = 0; c < signatures[id].captureCount; ++c) {
+            const auto& capture = captureRecords[signatures[id].firstCapture + c];
+            result.push_back({ std::string(strings + capture.nameOffset, capture.nameLength), capture.type, capture.offset });
+        }
+        return result;
+    }
+    const uint32_t* bucketStarts() const { return buckets; }
+    const SigDbEntry* bucketEntries() const { return entries; }
+
+private:
+    bool attach(const uint8_t* base, size_t size) {
+        if (size < sizeof(SigDbHeader)) return false;
+
+        header = reinterpret_cast<const SigDbHeader*>(base);
+        if (std::memcmp(header->magic, SIGDB_MAGIC, sizeof(SIGDB_MAGIC)) != 0 || header->version != SIGDB_VERSION)
+            return false;
+
+        auto fits = [size](uint64_t offset, uint64_t length) { return offset <= size && length <= size - offset; };
+        if (!fits(header->signaturesOffset, uint64_t(header->signatureCount) * sizeof(SigDbSignature)) ||
+            !fits(header->bucketsOffset, uint64_t(SIGDB_BUCKET_COUNT + 1) * sizeof(uint32_t)) ||
+            !fits(header->entriesOffset, uint64_t(header->entryCount) * sizeof(SigDbEntry)) ||
+            !fits(header->bytesOffset, header->bytesSize) ||
+            !fits(header->stringsOffset, header->stringsSize) ||
+            !fits(header->capturesOffset, uint64_t(header->captureCount) * sizeof(SigDbCapture)))
+            return false;
+
+        signatures = reinterpret_cast<const SigDbSignature*>(base + header->signaturesOffset);
+        buckets = reinterpret_cast<const uint32_t*>(base + header->bucketsOffset);
+        entries = reinterpret_cast<const SigDbEntry*>(base + header->entriesOffset);
+        bytes = base + header->bytesOffset;
+        strings = reinterpret_cast<const char*>(base + header->stringsOffset);
+        captureRecords = reinterpret_cast<const SigDbCapture*>(base + header->capturesOffset);
+
+        // Non-decreasing starts ending at entryCount keep every bucket inside `entries`.
+        if (buckets[SIGDB_BUCKET_COUNT] != header->entryCount) return false;
+        for (size_t k = 0; k < SIGDB_BUCKET_COUNT; ++k) {
+            if (buckets[k] > buckets[k + 1]) return false;
+        }
+        for (uint32_t i = 0; i < header->signatureCount; ++i) {
+            const auto& sig = signatures[i];
+            if (uint64_t(sig.patternOffset) + 2ull * sig.length > header->bytesSize ||
+                uint64_t(sig.nameOffset) + sig.nameLength > header->stringsSize ||
+                uint64_t(sig.noteOffset) + sig.noteLength > header->stringsSize ||
+                sig.length == 0 || sig.anchorOffset >= sig.length ||
+                sig.alternative >= sig.alternatives || sig.alternative > i ||
+                uint64_t(i - sig.alternative) + sig.alternatives > header->signatureCount ||
+                signatures[i - sig.alternative].alternatives != sig.alternatives ||
+                uint64_t(sig.firstCapture) + sig.captureCount > header->captureCount)
+                return false;
+        }
+        for (uint32_t i = 0; i < header->captureCount; ++i) {
+            const auto& capture = captureRecords[i];
+            if (uint64_t(capture.nameOffset) + capture.nameLength > header->stringsSize ||
+                capture.type > CaptureType::U64)
+                return false;
+        }
+        for (uint32_t i = 0; i < header->signatureCount; ++i) {
+            const auto& sig = signatures[i];
+            for (uint32_t c = 0; c < sig.captureCount; ++c) {
+                const auto& capture = captureRecords[sig.firstCapture + c];
+                if (uint64_t(capture.offset) + captureSize(capture.type) > sig.length) return false;
+            }
+        }
+        for (uint32_t i = 0; i < header->entryCount; ++i) {
+            if (entries[i].signature >= header->signatureCount) return false;
+        }
+
+        return true;
+    }
+
+    std::vector<uint8_t> ownedImage;
+    MappedFile mappedFile;
+    const SigDbHeader* header = nullptr;
+    const SigDbSignature* signatures = nullptr;
+    const uint32_t* buckets = nullptr;
+    const SigDbEntry* entries = nullptr;
+    const uint8_t* bytes = nullptr;
+    const char* strings = nullptr;
+    const SigDbCapture* captureRecords = nullptr;
+};
+
+// Accepts both a compiled database (memory-mapped, no parsing) and a text signature file.
+std::optional<SignatureDatabase> loadSignatureDatabase(const fs::path& filePath) {
+    SignatureDatabase database;
+
+    MappedFile mapped;
+    if (mapped.open(filePath) && mapped.size() >= sizeof(SIGDB_MAGIC) &&
+        std::memcmp(mapped.data(), SIGDB_MAGIC, sizeof(SIGDB_MAGIC)) == 0) {
+        if (!database.loadMapped(std::move(mapped))) {
+            std::cerr << RED << "[-] Corrupt or incompatible signature database: " << filePath << RESET << '\n';
+            return std::nullopt;
+        }
+        return database;
+    }
+
+    const auto signatures = parseSignatureFile(filePath);
+    if (signatures.empty() || !database.loadImage(compileSignatureDatabase(signatures))) {
+        std::cerr << RED << "[-] No valid signatures in: " << filePath << RESET << '\n';
+        return std::nullopt;
+    }
+    return database;
+}
+
+bool compileSignatureFile(const fs::path& inputPath, const fs::path& outputPath) {
+    const auto signatures = parseSignatureFile(inputPath);
+    if (signatures.empty()) {
+        std::cerr << RED << "[-] No valid signatures in: " << inputPath << RESET << '\n';
+        return false;
+    }
+
+    const auto image = compileSignatureDatabase(signatures);
+    std::ofstream outFile(outputPath, std::ios::binary);
+    if (!outFile) {
+        std::cerr << RED << "[-] Failed to create: " << outputPath << RESET << '\n';
+        return false;
+    }
+    outFile.write(reinterpret_cast<const char*>(image.data()), static_cast<std::streamsize>(image.size()));
+    outFile.close();
+    if (!outFile) {
+        std::cerr << RED << "[-] Failed to write: " << outputPath << RESET << '\n';
+        return false;
+    }
+
+    const auto chains = std::count_if(signatures.begin(), signatures.end(),
+                                      [](const SignatureSource& source) { return source.alternative == 0; });
+    std::cout << GREEN << "[+]" << RESET << " Compiled " << chains << " signatures (" << signatures.size()
+              << " patterns) -> " << outputPath.string() << " (" << image.size() << " bytes)\n";
+    return true;
+}
+
+// Work attributed to one signature by --profile. Every candidate (anchor hit) and byte
+// compared is counted exactly. Time is only estimated: each verification batch is timed
+// as a whole and split between its candidates by bytes compared, and the bucket walk
+// (the rest of the chunk) is split by candidates.
+constexpr size_t PROFILE_REPORT_LIMIT = 25;
+
+struct SignatureCost {
+    uint64_t candidates = 0;
+    uint64_t verifiedBytes = 0;
+    uint64_t matches = 0;
+    double estimatedNanoseconds = 0;
+};
+
+// Anchor hits are verified in batches of this many: the pattern bytes and the data of the
+// whole batch are prefetched before the first comparison.
+constexpr size_t VERIFY_BATCH_SIZE = 32;
+
+inline void prefetchRead(const void* address) {
+#ifdef PATTERNV_SSE2
+    _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#elif defined(__GNUC__)
+    __builtin_prefetch(address);
+#else
+    (void)address;
+#endif
+}
+
+// Index of the first byte where `data` differs from the pattern under its mask, or
+// `length` on a match. Compares 16 bytes per step with SSE2, then 8 bytes per word.
+inline uint32_t firstMismatch(const uint8_t* data, const uint8_t* value, const uint8_t* mask, uint32_t length) {
+    uint32_t j = 0;
+#ifdef PATTERNV_SSE2
+    for (; j + 16 <= length; j += 16) {
+        const __m128i bytes = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + j)),
+                                            _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask + j)));
+        const __m128i equal = _mm_cmpeq_epi8(bytes, _mm_loadu_si128(reinterpret_cast<const __m128i*>(value + j)));
+        const unsigned differ = ~static_cast<unsigned>(_mm_movemask_epi8(equal)) & 0xFFFF;
+        if (differ != 0) return j + static_cast<uint32_t>(std::countr_zero(differ));
+    }
+#endif
+    for (; j + 8 <= length; j += 8) {
+        uint64_t bytes, wordValue, wordMask;
+        std::memcpy(&bytes, data + j, 8);
+        std::memcpy(&wordValue, value + j, 8);
+        std::memcpy(&wordMask, mask + j, 8);
+        const uint64_t differ = (bytes & wordMask) ^ wordValue;
+        if (differ != 0) {
+            if constexpr (std::endian::native == std::endian::little) return j + std::countr_zero(differ) / 8;
+            else return j + std::countl_zero(differ) / 8;
+        }
+    }
+    while (j < length && (data[j] & mask[j]) == value[j]) ++j;
+    return j;
+}
+
+// Runs every signature of the database over `data` in one pass.
+std::vector<MatchSet> searchSignatures(const SignatureDatabase& database, const uint8_t* data, size_t size,
+                                       bool* complete = nullptr, std::vector<SignatureCost>* costs = nullptr) {
+    std::vector<MatchSet> matches(database.size());
+    if (complete) *complete = true;
+    if (size == 0) return matches;
+
+    const uint32_t* buckets = database.bucketStarts();
+    const SigDbEntry* entries = database.bucketEntries();
+
+    struct Candidate {
+        uint32_t signature;
+        size_t start;
+        uint32_t verified;
+        bool matched;
+    };
+    std::array<Candidate, VERIFY_BATCH_SIZE> batch;
+    size_t batchSize = 0;
+
+    // Profiling state: time spent verifying in the current chunk, and this call's
+    // candidates per signature to split the bucket walk by at the end.
+    using ProfileClock = std::chrono::steady_clock;
+    double verifyNanoseconds = 0;
+    double walkNanoseconds = 0;
+    std::vector<uint64_t> walkCandidates(costs ? database.size() : 0);
+    uint64_t totalCandidates = 0;
+
+    auto verifyBatch = [&] {
+        if (batchSize == 0) return;
+        const auto batchStart = costs ? ProfileClock::now() : ProfileClock::time_point{};
+
+        for (size_t c = 0; c < batchSize; ++c) {
+            prefetchRead(data + batch[c].start);
+            prefetchRead(database.value(batch[c].signature));
+        }
+
+        for (size_t c = 0; c < batchSize; ++c) {
+            auto& candidate = batch[c];
+            const uint32_t id = candidate.signature;
+            const SigDbSignature& sig = database.signature(id);
+            const uint32_t j = firstMismatch(data + candidate.start, database.value(id), database.mask(id), sig.length);
+            candidate.matched = j == sig.length;
+            candidate.verified = std::min(j + 1, sig.length);
+            if (candidate.matched) matches[id].push_back(candidate.start);
+        }
+
+        if (costs) {
+            const double elapsed = static_cast<double>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(ProfileClock::now() - batchStart).count());
+            verifyNanoseconds += elapsed;
+
+            uint64_t batchBytes = 0;
+            for (size_t c = 0; c < batchSize; ++c) batchBytes += batch[c].verified;
+            for (size_t c = 0; c < batchSize; ++c) {
+                const auto& candidate = batch[c];
+                auto& cost = (*costs)[candidate.signature];
+                ++cost.candidates;
+                cost.verifiedBytes += candidate.verified;
+                cost.matches += candidate.matched;
+                cost.estimatedNanoseconds += elapsed * candidate.verified / static_cast<double>(batchBytes);
+                ++walkCandidates[candidate.signature];
+            }
+            totalCandidates += batchSize;
+        }
+        batchSize = 0;
+    };
+
+    // Two-byte keys cover every position but the final one, handled after the loop.
+    const size_t last = size - 2;
+    bool interrupted = false;
+    for (size_t chunk = 0; size >= 2 && chunk <= last; chunk += SCAN_CHUNK_SIZE) {
+        if (scanInterrupted()) {
+            if (complete) *complete = false;
+            interrupted = true;
+            break;
+        }
+
+        const auto chunkStart = costs ? ProfileClock::now() : ProfileClock::time_point{};
+        verifyNanoseconds = 0;
+
+        const size_t chunkEnd = std::min(last, chunk + SCAN_CHUNK_SIZE - 1);
+        for (size_t i = chunk; i <= chunkEnd; ++i) {
+            const uint32_t key = data[i] | (data[i + 1] << 8);
+            for (uint32_t e = buckets[key]; e < buckets[key + 1]; ++e) {
+                const SigDbEntry& entry = entries[e];
+                if (i < entry.anchorOffset) continue;
+
+                const size_t start = i - entry.anchorOffset;
+                if (start + database.signature(entry.signature).length > size) continue;
+
+                batch[batchSize++] = { entry.signature, start, 0, false };
+                if (batchSize == VERIFY_BATCH_SIZE) verifyBatch();
+            }
+        }
+        verifyBatch();
+
+        if (costs) {
+            const double elapsed = static_cast<double>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(ProfileClock::now() - chunkStart).count());
+            walkNanoseconds += std::max(0.0, elapsed - verifyNanoseconds);
+        }
+    }
+
+    // The final byte has no successor to form a key with. Only a single-byte anchor on the
+    // last byte of its signature can sit there; such an entry is filed under every
+    // successor byte, so the bucket for successor 0 holds all of them.
+    if (!interrupted) {
+        const size_t i = size - 1;
+        const uint32_t key = data[i];
+        for (uint32_t e = buckets[key]; e < buckets[key + 1]; ++e) {
+            const SigDbEntry& entry = entries[e];
+            const SigDbSignature& sig = database.signature(entry.signature);
+            if (entry.anchorOffset + 1 != sig.length || i < entry.anchorOffset) continue;
+
+            batch[batchSize++] = { entry.signature, i - entry.anchorOffset, 0, false };
+            if (batchSize == VERIFY_BATCH_SIZE) verifyBatch();
+        }
+        verifyBatch();
+    }
+
+    if (costs && totalCandidates > 0) {
+        for (size_t id = 0; id < walkCandidates.size(); ++id) {
+            (*costs)[id].estimatedNanoseconds +=
+                walkNanoseconds * static_cast<double>(walkCandidates[id]) / static_cast<double>(totalCandidates);
+        }
+    }
+
+    return matches;
+}
+
+// searchSignatures over everything but `skipped`, with the same rule as searchKeptRanges.
+std::vector<MatchSet> searchSignaturesKeptRanges(const SignatureDatabase& database, const uint8_t* data, size_t size,
+                                                 const std::vector<TextRange>& skipped, bool* complete = nullptr,
+                                                 std::vector<SignatureCost>* costs = nullptr) {
+    if (skipped.empty()) return searchSignatures(database, data, size, complete, costs);
+
+    size_t overlap = 0;
+    for (size_t id = 0; id < database.size(); ++id) overlap = std::max<size_t>(overlap, database.signature(id).length - 1);
+
+    std::vector<MatchSet> matches(database.size());
+    if (complete) *complete = true;
+    forEachKeptRange(skipped, size, [&](size_t begin, size_t end) {
+        bool rangeComplete = true;
+        const size_t searchEnd = std::min(size, end + overlap);
+        const auto found = searchSignatures(database, data + begin, searchEnd - begin, &rangeComplete, costs);
+        for (size_t id = 0; id < found.size(); ++id) {
+            for (size_t offset : found[id]) {
+                if (offset >= end - begin) break;
+                matches[id].push_back(begin + offset);
+            }
+        }
+        if (!rangeComplete && complete) *complete = false;
+    });
+    return matches;
+}
+
+// Resolves the fallback chain starting at `head` from the match count of every record:
+// the first alternative that matches exactly once, else the first that matches at all.
+std::optional<size_t> resolveChain(const SignatureDatabase& database, size_t head, const std::vector<size_t>& counts) {
+    const size_t end = head + database.signature(head).alternatives;
+    for (size_t id = head; id < end; ++id) {
+        if (counts[id] == 1) return id;
+    }
+    for (size_t id = head; id < end; ++id) {
+        if (counts[id] > 0) return id;
+    }
+    return std::nullopt;
+}
+
+// Tells which alternative of a chain produced a result; empty for the primary pattern.
+std::string alternativeLabel(const SignatureDatabase& database, size_t id) {
+    const auto& sig = database.signature(id);
+    if (sig.alternative == 0) return {};
+    return " [alternative " + std::to_string(sig.alternative + 1) + "/" + std::to_string(sig.alternatives) + "]";
+}
+
+// Resolves the fallback chains of one build and formats them; `missing` receives the
+// number of chains without any match.
+std::string formatSignatureResults(const SignatureDatabase& database, const std::string& gameName,
+                                   const std::string& build, const std::vector<MatchSet>& matches, bool complete,
+                                   size_t& missing, const SymbolTable* symbols = nullptr, uint32_t textRva = 0)
+{
+    std::vector<size_t> counts(matches.size());
+    for (size_t id = 0; id < matches.size(); ++id) counts[id] = matches[id].size();
+
+    std::vector<std::optional<size_t>> winners;
+    for (size_t head = 0; head < matches.size(); head += database.signature(head).alternatives) {
+        winners.push_back(resolveChain(database, head, counts));
+    }
+    const size_t found = winners.size() - std::count(winners.begin(), winners.end(), std::nullopt);
+    missing = winners.size() - found;
+
+    std::ostringstream oss;
+    if (!minifiedOutput) {
+        oss << (found == winners.size() ? GREEN : RED) << (found == winners.size() ? "[+]" : "[-]") << RESET
+            << " " << gameName << " v" << YELLOW << build << RESET << ": " << found << "/"
+            << winners.size() << " signatures found";
+        if (!complete) oss << YELLOW << " (incomplete)" << RESET;
+    }
+
+    for (size_t head = 0, chain = 0; head < matches.size(); head += database.signature(head).alternatives, ++chain) {
+        const size_t id = winners[chain].value_or(head);
+        const auto& set = matches[id];
+        if (chain > 0 || !minifiedOutput) oss << '\n';
+
+        if (minifiedOutput) {
+            oss << (set.empty() ? RED : GREEN) << (set.empty() ? "[-] " : "[+] ") << RESET << gameName << "_"
+                << build << " " << database.name(id) << alternativeLabel(database, id) << " (" << std::dec
+                << set.size() << " matches)";
+        } else {
+            oss << "    " << (set.empty() ? RED : GREEN) << (set.empty() ? "[-]" : "[+]") << RESET << " "
+                << database.name(id) << alternativeLabel(database, id) << " (" << std::dec << set.size() << " matches)";
+        }
+
+        if (!set.empty() && !countOnlyOutput) {
+            oss << ": ";
+            bool first = true;
+            for (size_t offset : set) {
+                if (!first)
+                    oss << ", ";
+                oss << (minifiedOutput ? "" : YELLOW) << "0x" << std::hex << std::uppercase << offset
+                    << (minifiedOutput ? "" : RESET) << symbolLabel(symbols, textRva, offset);
+                first = false;
+            }
+        }
+    }
+
+    return oss.str();
+}
+
+void scanSignaturesInFile(const fs::path& filePath, const SignatureDatabase& database, size_t& missing,
+                          std::vector<SignatureCost>* totalCosts, std::mutex& outputMutex,
+                          std::vector<ResultLine>& outputBuffer)
+{
+    sem.acquire();
+    if (reportSkippedIfInterrupted(filePath, outputMutex, outputBuffer)) {
+        sem.release();
+        return;
+    }
+
+    const auto image = loadBuildImage(filePath);
+    if (!image.has_value()) {
+        sem.release();
+        return;
+    }
+
+    bool complete = true;
+    std::vector<SignatureCost> costs(totalCosts ? database.size() : 0);
+    const auto skipped = skippedRanges(*image);
+    const auto matches = searchSignaturesKeptRanges(database, image->text(), image->textSize, skipped, &complete,
+                                                    totalCosts ? &costs : nullptr);
+    sem.release();
+
+    size_t chainMisses = 0;
+    const auto symbols = loadBuildSymbols(filePath);
+    const auto line = formatSignatureResults(database, image->gameName, image->build, matches, complete, chainMisses,
+                                             symbols ? &*symbols : nullptr, image->textRva);
+
+    std::lock_guard lock(outputMutex);
+    missing += chainMisses;
+    for (size_t id = 0; totalCosts && id < costs.size(); ++id) {
+        auto& total = (*totalCosts)[id];
+        total.candidates += costs[id].candidates;
+        total.verifiedBytes += costs[id].verifiedBytes;
+        total.matches += costs[id].matches;
+        total.estimatedNanoseconds += costs[id].estimatedNanoseconds;
+    }
+    outputBuffer.push_back({ image->buildNumber, line, !complete });
+}
+
+
+// Ranks the signatures by their estimated share of verification time. A single-byte
+// anchor (no two adjacent fixed bytes) sits in 256 buckets and is the usual culprit.
+void printSignatureProfile(const SignatureDatabase& database, const std::vector<SignatureCost>& costs) {
+    std::vector<size_t> order(costs.size());
+    for (size_t id = 0; id < order.size(); ++id) order[id] = id;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return std::tie(costs[a].estimatedNanoseconds, costs[a].verifiedBytes) >
+               std::tie(costs[b].estimatedNanoseconds, costs[b].verifiedBytes);
+    });
+
+    double totalNanoseconds = 0;
+    for (const auto& cost : costs) totalNanoseconds += cost.estimatedNanoseconds;
+
+    std::cout << "\n[~] Signature cost profile (time estimated from timed verification batches and chunks):\n";
+    for (size_t rank = 0; rank < order.size() && rank < PROFILE_REPORT_LIMIT; ++rank) {
+        const size_t id = order[rank];
+        const auto& cost = costs[id];
+        const auto& sig = database.signature(id);
+        const bool weakAnchor = sig.anchorOffset + 1 >= sig.length || !database.mask(id)[sig.anchorOffset + 1];
+
+        std::cout << "    " << std::setw(3) << rank + 1 << ". " << (weakAnchor ? YELLOW : "") << database.name(id)
+                  << alternativeLabel(database, id) << (weakAnchor ? " (1-byte anchor)" : "") << RESET << ": "
+                  << cost.candidates << " candidates, " << cost.verifiedBytes / 1024 << " KB verified, "
+                  << cost.matches << " matches, ~" << std::fixed << std::setprecision(2)
+                  << cost.estimatedNanoseconds / 1e6 << " ms est. (" << std::setprecision(1)
+                  << (totalNanoseconds > 0 ? 100.0 * cost.estimatedNanoseconds / totalNanoseconds : 0.0) << "%)\n";
+    }
+}
+
+bool scanSignatureDirectory(const fs::path& folderPath, const SignatureDatabase& database) {
+    using namespace std::chrono;
+    const auto start = high_resolution_clock::now();
+    beginScan();
+
+    std::vector<ResultLine> outputBuffer;
+    std::mutex outputMutex;
+    std::vector<std::future<void>> futures;
+    size_t missing = 0;
+    std::vector<SignatureCost> costs(profileSignatures ? database.size() : 0);
+
+    for (const auto& path : listBuildFiles(folderPath)) {
+        futures.push_back(std::async(std::launch::async, scanSignaturesInFile,
+                                     path, std::cref(database), std::ref(missing),
+                                     profileSignatures ? &costs : nullptr,
+                                     std::ref(outputMutex), std::ref(outputBuffer)));
+    }
+
+    for (auto& f : futures) f.get();
+    endScan();
+
+    std::sort(outputBuffer.begin(), outputBuffer.end(),
+              [](const ResultLine& a, const ResultLine& b) {
+                  return a.build < b.build;
+              });
+
+    bool anyIncomplete = false;
+    for (const auto& result : outputBuffer) {
+        std::cout << result.line << '\n';
+        anyIncomplete |= result.incomplete;
+    }
+
+    if (anyIncomplete) {
+        std::cout << YELLOW << "[!]" << RESET << (scanTimedOut.load() ? " Query timed out" : " Scan cancelled")
+                  << ", results are partial\n";
+    }
+
+    if (profileSignatures) printSignatureProfile(database, costs);
+
+    const auto end = high_resolution_clock::now();
+    if (!hideTime) {
+        std::cout << "\n[~] " << database.chainCount() << " signatures scanned in "
+                  << duration_cast<milliseconds>(end - start).count()
+                  << " ms\n";
+    }
+
+    return missing == 0 && !anyIncomplete;
+}
+
+// Resident corpus: the .text sections of every build, published once into a named
+// shared-memory segment so that later invocations attach to it with --attach and scan
+// without any file I/O or PE parsing. Sections start on page boundaries.
+constexpr char CORPUS_MAGIC[8] = { 'P', 'V', 'C', 'O', 'R', 'P', 'U', 'S' };
+constexpr uint32_t CORPUS_VERSION = 1;
+constexpr size_t CORPUS_SECTION_ALIGNMENT = 0x1000;
+
+struct CorpusHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t buildCount;
+    uint64_t buildsOffset;
+    uint64_t stringsOffset;
+    uint64_t stringsSize;
+    uint64_t totalSize;
+};
+
+struct CorpusBuild {
+    uint32_t gameOffset;
+    uint32_t gameLength;
+    uint32_t buildOffset;
+    uint32_t buildLength;
+    int32_t buildNumber;
+    uint32_t reserved;
+    uint64_t textOffset;
+    uint64_t textSize;
+};
+
+static_assert(sizeof(CorpusHeader) == 48);
+static_assert(sizeof(CorpusBuild) == 40);
+
+class Corpus {
+public:
+    bool attach(SharedSegment shared) {
+        segment = std::move(shared);
+        const uint8_t* base = segment.data();
+        const size_t size = segment.size();
+        if (size < sizeof(CorpusHeader)) return false;
+
+        header = reinterpret_cast<const CorpusHeader*>(base);
+        if (std::memcmp(header->magic, CORPUS_MAGIC, sizeof(CORPUS_MAGIC)) != 0 || header->version != CORPUS_VERSION ||
+            header->totalSize > size)
+            return false;
+
+        auto fits = [size](uint64_t offset, uint64_t length) { return offset <= size && length <= size - offset; };
+        if (!fits(header->buildsOffset, uint64_t(header->buildCount) * sizeof(CorpusBuild)) ||
+            !fits(header->stringsOffset, header->stringsSize))
+            return false;
+
+        builds = reinterpret_cast<const CorpusBuild*>(base + header->buildsOffset);
+        strings = reinterpret_cast<const char*>(base + header->stringsOffset);
+        for (uint32_t i = 0; i < header->buildCount; ++i) {
+            const auto& build = builds[i];
+            if (uint64_t(build.gameOffset) + build.gameLength > header->stringsSize ||
+                uint64_t(build.buildOffset) + build.buildLength > header->stringsSize ||
+                !fits(build.textOffset, build.textSize))
+                return false;
+        }
+        return true;
+    }
+
+    size_t size() const { return header->buildCount; }
+    std::string gameName(size_t i) const { return { strings + builds[i].gameOffset, builds[i].gameLength }; }
+    std::string build(size_t i) const { return { strings + builds[i].buildOffset, builds[i].buildLength }; }
+    int buildNumber(size_t i) const { return builds[i].buildNumber; }
+    const uint8_t* text(size_t i) const { return segment.data() + builds[i].textOffset; }
+    size_t textSize(size_t i) const { return builds[i].textSize; }
+    size_t totalSize() const { return header->totalSize; }
+
+private:
+    SharedSegment segment;
+    const CorpusHeader* header = nullptr;
+    const CorpusBuild* builds = nullptr;
+    const char* strings = nullptr;
+};
+
+// Lays the corpus out from the section headers alone, then reads each .text straight into
+// the segment. Stays resident, serving the segment, until interrupted.
+bool publishCorpus(const fs::path& folderPath, const std::string& name) {
+    using namespace std::chrono;
+    const auto start = high_resolution_clock::now();
+
+    struct Entry {
+        fs::path path;
+        SectionInfo section;
+        CorpusBuild record;
+    };
+    std::vector<Entry> entries;
+    std::string strings;
+    for (const auto& path : listBuildFiles(folderPath)) {
+        const auto section = locateTextSection(path);
+        if (!section.has_value()) {
+            std::cerr << RED << "[-] .text section not found in: " << path.filename().string() << RESET << '\n';
+            continue;
+        }
+
+        const auto filename = path.filename().string();
+        const auto game = extractGameName(filename);
+        const auto build = extractBuildNumber(filename).value_or(filename);
+
+        CorpusBuild record{};
+        record.gameOffset = static_cast<uint32_t>(strings.size());
+        record.gameLength = static_cast<uint32_t>(game.size());
+        strings += game;
+        record.buildOffset = static_cast<uint32_t>(strings.size());
+        record.buildLength = static_cast<uint32_t>(build.size());
+        strings += build;
+        record.buildNumber = parseBuildNumber(build);
+        record.textSize = section->rawSize;
+        entries.push_back({ path, *section, record });
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry& a, const Entry& b) { return a.record.buildNumber < b.record.buildNumber; });
+
+    auto alignTo = [](size_t value, size_t alignment) { return (value + alignment - 1) & ~(alignment - 1); };
+
+    // The magic is left zero until every section is in place, so that a reader attaching
+    // while the corpus is still being filled rejects it instead of scanning partial data.
+    CorpusHeader header{};
+    header.version = CORPUS_VERSION;
+    header.buildCount = static_cast<uint32_t>(entries.size());
+    header.buildsOffset = sizeof(CorpusHeader);
+    header.stringsOffset = header.buildsOffset + entries.size() * sizeof(CorpusBuild);
+    header.stringsSize = strings.size();
+
+    size_t cursor = alignTo(header.stringsOffset + strings.size(), CORPUS_SECTION_ALIGNMENT);
+    for (auto& entry : entries) {
+        entry.record.textOffset = cursor;
+        cursor = alignTo(cursor + entry.record.textSize, CORPUS_SECTION_ALIGNMENT);
+    }
+    header.totalSize = cursor;
+
+    SharedSegment segment;
+    if (!segment.create(name, header.totalSize)) {
+        std::cerr << RED << "[-] Failed to create shared corpus '" << name
+                  << "' (already published, or no shared memory available)" << RESET << '\n';
+        return false;
+    }
+
+    uint8_t* base = segment.data();
+    std::memcpy(base, &header, sizeof(header));
+    for (size_t i = 0; i < entries.size(); ++i) {
+        std::memcpy(base + header.buildsOffset + i * sizeof(CorpusBuild), &entries[i].record, sizeof(CorpusBuild));
+    }
+    if (!strings.empty()) std::memcpy(base + header.stringsOffset, strings.data(), strings.size());
+
+    std::vector<std::future<bool>> futures;
+    for (const auto& entry : entries) {
+        futures.push_back(std::async(std::launch::async, [&entry, base] {
+            sem.acquire();
+            const auto bytes = readFileRange(entry.path, entry.section.rawOffset, entry.section.rawSize);
+            sem.release();
+            if (bytes.size() != entry.section.rawSize) return false;
+            std::memcpy(base + entry.record.textOffset, bytes.data(), bytes.size());
+            return true;
+        }));
+    }
+    bool complete = true;
+    for (auto& f : futures) complete &= f.get();
+    if (!complete) {
+        std::cerr << RED << "[-] Failed to read every build into the shared corpus" << RESET << '\n';
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(reinterpret_cast<CorpusHeader*>(base)->magic, CORPUS_MAGIC, sizeof(CORPUS_MAGIC));
+
+    const auto end = high_resolution_clock::now();
+    std::cout << GREEN << "[+]" << RESET << " Published " << entries.size() << " builds as '" << name << "' ("
+              << header.totalSize / (1024 * 1024) << " MB) in " << duration_cast<milliseconds>(end - start).count()
+              << " ms. Press Ctrl-C to unpublish." << std::endl;
+
+    // The segment is only valid while it is mapped here, so interrupting unpublishes it.
+    beginScan();
+    while (!scanCancelled.load()) std::this_thread::sleep_for(milliseconds(200));
+    endScan();
+
+    std::cout << YELLOW << "[~]" << RESET << " Unpublished '" << name << "'\n";
+    return true;
+}
+
+std::optional<Corpus> attachCorpus(const std::string& name) {
+    SharedSegment segment;
+    if (!segment.open(name)) {
+        std::cerr << RED << "[-] No shared corpus named '" << name << "' (publish it with --publish-corpus)" << RESET << '\n';
+        return std::nullopt;
+    }
+
+    Corpus corpus;
+    if (!corpus.attach(std::move(segment))) {
+        std::cerr << RED << "[-] Corrupt or incompatible shared corpus: " << name << RESET << '\n';
+        return std::nullopt;
+    }
+    return corpus;
+}
+
+// Same output as scanDirectory / scanSignatureDirectory, with the sections served from an
+// attached corpus. Pass either a pattern or a signature database.
+bool scanCorpus(const Corpus& corpus, const BytePattern* pattern, const SignatureDatabase* database) {
+    using namespace std::chrono;
+    const auto start = high_resolution_clock::now();
+    beginScan();
+
+    std::vector<ResultLine> outputBuffer(corpus.size());
+    std::vector<size_t> missing(corpus.size());
+    std::vector<std::future<void>> futures;
+    for (size_t i = 0; i < corpus.size(); ++i) {
+        futures.push_back(std::async(std::launch::async, [&, i] {
+            sem.acquire();
+            bool complete = true;
+            if (database) {
+                const auto matches = searchSignatures(*database, corpus.text(i), corpus.textSize(i), &complete);
+                outputBuffer[i].line = formatSignatureResults(*database, corpus.gameName(i), corpus.build(i), matches,
+                                                              complete, missing[i]);
+            } else {
+                const auto matches = searchAllPatternOffsets(corpus.text(i), corpus.textSize(i), *pattern, &complete);
+                outputBuffer[i].line = formatPatternResult(corpus.gameName(i), corpus.build(i), matches,
+                                                           countOnlyOutput, complete);
+                missing[i] = matches.empty();
+            }
+            outputBuffer[i].incomplete = !complete;
+            sem.release();
+        }));
+    }
+
+    for (auto& f : futures) f.get();
+    endScan();
+
+    bool anyIncomplete = false;
+    for (const auto& result : outputBuffer) {
+        std::cout << result.line << '\n';
+        anyIncomplete |= result.incomplete;
+    }
+
+    if (anyIncomplete) {
+        std::cout << YELLOW << "[!]" << RESET << (scanTimedOut.load() ? " Query timed out" : " Scan cancelled")
+                  << ", results are partial\n";
+    }
+
+    const auto end = high_resolution_clock::now();
+    if (!hideTime) {
+        std::cout << "\n[~] Scan completed in "
+                << duration_cast<milliseconds>(end - start).count()
+                << " ms\n";
+    }
+
+    return std::accumulate(missing.begin(), missing.end(), size_t(0)) == 0 && !anyIncomplete;
+}
+
+// Sharded scanning: the coordinator (--workers N) starts N copies of itself in worker
+// mode, each holding a contiguous range of the builds in memory, and sends every query
+// to all of them over their stdin. A worker answers with one length-prefixed record per
+// build (`R <build> <incomplete> <missing> <bytes>` followed by the formatted result)
+// and `E` once done, so the coordinator only merges records in build order. `C` cancels
+// the query in flight; workers ignore Ctrl-C themselves and only stop on that command
+// or when their input closes. Nothing about the protocol assumes a pipe, which keeps
+// shards movable to other hosts later.
+class WorkerProcess {
+public:
+    WorkerProcess() = default;
+    WorkerProcess(const WorkerProcess&) = delete;
+    WorkerProcess& operator=(const WorkerProcess&) = delete;
+
+    ~WorkerProcess() {
+#ifdef _WIN32
+        if (input) CloseHandle(input);
+        if (output) CloseHandle(output);
+        if (process) {
+            WaitForSingleObject(process, INFINITE);
+            CloseHandle(process);
+        }
+#else
+        if (input >= 0) ::close(input);
+        if (output >= 0) ::close(output);
+        if (pid > 0) waitpid(pid, nullptr, 0);
+#endif
+    }
+
+    bool start(const fs::path& executable, const std::vector<std::string>& args) {
+#ifdef _WIN32
+        SECURITY_ATTRIBUTES inherit{ sizeof(SECURITY_ATTRIBUTES), nullptr, TRUE };
+        HANDLE childInput = nullptr;
+        HANDLE childOutput = nullptr;
+        if (!CreatePipe(&childInput, &input, &inherit, 0)) return false;
+        if (!CreatePipe(&output, &childOutput, &inherit, 0)) {
+            CloseHandle(childInput);
+            return false;
+        }
+        SetHandleInformation(input, HANDLE_FLAG_INHERIT, 0);
+        SetHandleInformation(output, HANDLE_FLAG_INHERIT, 0);
+
+        std::wstring commandLine = L"\"" + executable.wstring() + L"\"";
+        for (const auto& arg : args) commandLine += L" \"" + fs::path(arg).wstring() + L"\"";
+
+        STARTUPINFOW startup{};
+        startup.cb = sizeof(startup);
+        startup.dwFlags = STARTF_USESTDHANDLES;
+        startup.hStdInput = childInput;
+        startup.hStdOutput = childOutput;
+        startup.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+
+        PROCESS_INFORMATION info{};
+        const BOOL created = CreateProcessW(nullptr, commandLine.data(), nullptr, nullptr, TRUE, 0, nullptr, nullptr,
+                                            &startup, &info);
+        CloseHandle(childInput);
+        CloseHandle(childOutput);
+        if (!created) return false;
+
+        CloseHandle(info.hThread);
+        process = info.hProcess;
+#else
+        int toChild[2];
+        int fromChild[2];
+        if (pipe(toChild) != 0) return false;
+        if (pipe(fromChild) != 0) {
+            ::close(toChild[0]);
+            ::close(toChild[1]);
+            return false;
+        }
+
+        // Later workers must not inherit this worker's pipe ends, or it never sees EOF.
+        fcntl(toChild[1], F_SETFD, FD_CLOEXEC);
+        fcntl(fromChild[0], F_SETFD, FD_CLOEXEC);
+
+        pid = fork();
+        if (pid == 0) {
+            dup2(toChild[0], STDIN_FILENO);
+            dup2(fromChild[1], STDOUT_FILENO);
+            ::close(toChild[0]);
+            ::close(toChild[1]);
+            ::close(fromChild[0]);
+            ::close(fromChild[1]);
+
+            std::vector<char*> argv{ const_cast<char*>(executable.c_str()) };
+            for (const auto& arg : args) argv.push_back(const_cast<char*>(arg.c_str()));
+            argv.push_back(nullptr);
+            execv(executable.c_str(), argv.data());
+            std::_Exit(127);
+        }
+
+        ::close(toChild[0]);
+        ::close(fromChild[1]);
+        input = toChild[1];
+        output = fromChild[0];
+        if (pid < 0) return false;
+#endif
+        return true;
+    }
+
+    bool send(const std::string& line) {
+        const std::string message = line + '\n';
+        size_t written = 0;
+        while (written < message.size()) {
+#ifdef _WIN32
+            DWORD count = 0;
+            if (!WriteFile(input, message.data() + written, static_cast<DWORD>(message.size() - written), &count, nullptr)) {
+                dead = true;
+                return false;
+            }
+#else
+            const ssize_t count = ::write(input, message.data() + written, message.size() - written);
+            if (count < 0 && errno == EINTR) continue;
+            if (count <= 0) {
+                dead = true;
+                return false;
+            }
+#endif
+            written += static_cast<size_t>(count);
+        }
+        return true;
+    }
+
+    bool readLine(std::string& line) {
+        line.clear();
+        char c;
+        while (readBytes(&c, 1)) {
+            if (c == '\n') return true;
+            line += c;
+        }
+        return false;
+    }
+
+    bool readBytes(char* data, size_t size) {
+        while (size > 0) {
+            if (bufferPos == bufferEnd) {
+#ifdef _WIN32
+                DWORD count = 0;
+                if (!ReadFile(output, buffer.data(), static_cast<DWORD>(buffer.size()), &count, nullptr) || count == 0) {
+                    dead = true;
+                    return false;
+                }
+#else
+                const ssize_t count = ::read(output, buffer.data(), buffer.size());
+                if (count < 0 && errno == EINTR) continue;
+                if (count <= 0) {
+                    dead = true;
+                    return false;
+                }
+#endif
+                bufferPos = 0;
+                bufferEnd = static_cast<size_t>(count);
+            }
+
+            const size_t chunk = std::min(size, bufferEnd - bufferPos);
+            std::memcpy(data, buffer.data() + bufferPos, chunk);
+            bufferPos += chunk;
+            data += chunk;
+            size -= chunk;
+        }
+        return true;
+    }
+
+    // A worker whose pipe failed once is never asked again.
+    bool alive() const { return !dead; }
+
+private:
+    std::array<char, 64 * 1024> buffer{};
+    size_t bufferPos = 0;
+    size_t bufferEnd = 0;
+    bool dead = false;
+#ifdef _WIN32
+    HANDLE input = nullptr;
+    HANDLE output = nullptr;
+    HANDLE process = nullptr;
+#else
+    int input = -1;
+    int output = -1;
+    pid_t pid = -1;
+#endif
+};
+
+fs::path currentExecutable(const char* argv0) {
+#ifdef _WIN32
+    std::wstring path(MAX_PATH, L'\0');
+    const DWORD length = GetModuleFileNameW(nullptr, path.data(), static_cast<DWORD>(path.size()));
+    if (length > 0 && length < path.size()) {
+        path.resize(length);
+        return path;
+    }
+#else
+    std::error_code ec;
+    const auto path = fs::read_symlink("/proc/self/exe", ec);
+    if (!ec) return path;
+#endif
+    return fs::absolute(argv0);
+}
+
+// Worker side: loads its shard once, then answers queries until its input closes. A query
+// is `P <pattern>` or `S <signature file>`; `C` cancels the one being answered.
+int runWorker(const fs::path& folderPath, size_t shard, size_t shardCount) {
+#ifdef _WIN32
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    // Ctrl-C reaches the whole process group; the coordinator decides what it cancels.
+    std::signal(SIGINT, SIG_IGN);
+
+    auto files = listBuildFiles(folderPath);
+    std::sort(files.begin(), files.end(), [](const fs::path& a, const fs::path& b) {
+        return parseBuildNumber(extractBuildNumber(a.filename().string()).value_or("0")) <
+               parseBuildNumber(extractBuildNumber(b.filename().string()).value_or("0"));
+    });
+
+    std::vector<std::future<std::optional<BuildImage>>> futures;
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (i * shardCount / files.size() != shard) continue;
+        futures.push_back(std::async(std::launch::async, [path = files[i]] {
+            sem.acquire();
+            auto image = loadBuildImage(path);
+            sem.release();
+            return image;
+        }));
+    }
+    std::vector<BuildImage> images;
+    std::vector<std::vector<TextRange>> skipped;
+    std::vector<std::optional<SymbolTable>> symbols;
+    for (auto& f : futures) {
+        if (auto image = f.get()) {
+            skipped.push_back(skippedRanges(*image));
+            symbols.push_back(loadBuildSymbols(image->path));
+            images.push_back(std::move(*image));
+        }
+    }
+
+    // Input is read on its own thread so that a `C` arriving mid-query is seen at once.
+    // A cancel names the latest request received; the scan of that request checks it
+    // right after it starts, in case the command overtook it.
+    BoundedChannel<std::string> requests(16);
+    std::atomic<size_t> receivedRequests = 0;
+    std::atomic<size_t> cancelledRequest = 0;
+    std::thread reader([&] {
+        std::string line;
+        while (std::getline(std::cin, line)) {
+            if (line == "C") {
+                cancelledRequest.store(receivedRequests.load());
+                if (scanInProgress.load()) scanCancelled.store(true);
+            } else if (line.size() >= 2) {
+                ++receivedRequests;
+                requests.push(std::move(line));
+            }
+        }
+        requests.close();
+    });
+
+    std::unordered_map<std::string, SignatureDatabase> databases;
+    size_t answeredRequests = 0;
+    while (auto next = requests.pop()) {
+        const std::string& request = *next;
+        ++answeredRequests;
+
+        const SignatureDatabase* database = nullptr;
+        BytePattern pattern;
+        if (request[0] == 'S') {
+            auto it = databases.find(request.substr(2));
+            if (it == databases.end()) {
+                if (auto loaded = loadSignatureDatabase(request.substr(2))) {
+                    it = databases.emplace(request.substr(2), std::move(*loaded)).first;
+                }
+            }
+            if (it != databases.end()) database = &it->second;
+        } else {
+            pattern = parseBytePattern(request.substr(2));
+        }
+
+        std::vector<ResultLine> results(images.size());
+        std::vector<size_t> missing(images.size(), 1);
+        beginScan();
+        if (cancelledRequest.load() >= answeredRequests) scanCancelled.store(true);
+        std::vector<std::future<void>> scans;
+        for (size_t i = 0; i < images.size() && (database || !pattern.empty()); ++i) {
+            scans.push_back(std::async(std::launch::async, [&, i] {
+                sem.acquire();
+                const auto& image = images[i];
+                bool complete = true;
+                if (database) {
+                    const auto matches =
+                        searchSignaturesKeptRanges(*database, image.text(), image.textSize, skipped[i], &complete);
+                    results[i].line = formatSignatureResults(*database, image.gameName, image.build, matches, complete,
+                                                             missing[i], symbols[i] ? &*symbols[i] : nullptr, image.textRva);
+                } else {
+                    const auto matches = searchKeptRanges(image.text(), image.textSize, pattern, skipped[i], &complete);
+                    results[i].line = formatPatternResult(image.gameName, image.build, matches, countOnlyOutput, complete,
+                                                          symbols[i] ? &*symbols[i] : nullptr, image.textRva);
+                    missing[i] = matches.empty();
+                }
+                results[i].build = image.buildNumber;
+                results[i].incomplete = !complete;
+                sem.release();
+            }));
+        }
+        for (auto& f : scans) f.get();
+        endScan();
+
+        for (size_t i = 0; i < scans.size(); ++i) {
+            std::cout << "R " << results[i].build << " " << results[i].incomplete << " " << missing[i] << " "
+                      << results[i].line.size() << '\n' << results[i].line;
+        }
+        std::cout << "E" << std::endl;
+    }
+    reader.join();
+    return 0;
+}
+
+std::vector<std::unique_ptr<WorkerProcess>> startWorkers(const fs::path& executable, const fs::path& folderPath,
+                                                         size_t count) {
+#ifndef _WIN32
+    // A worker that died must surface as a failed write, not kill the coordinator.
+    std::signal(SIGPIPE, SIG_IGN);
+#endif
+    std::vector<std::string> args;
+    if (!useColors) args.push_back("--no-color");
+    if (!useManifest) args.push_back("--no-manifest");
+    if (minifiedOutput) args.push_back("--minified");
+    if (countOnlyOutput) args.push_back("--count-only");
+    if (skipOpaque) args.push_back("--skip-opaque");
+    if (annotateSymbols) args.push_back("--symbols");
+    if (queryTimeout.count() > 0) {
+        args.push_back("--timeout");
+        args.push_back(std::to_string(queryTimeout.count()));
+    }
+
+    std::vector<std::unique_ptr<WorkerProcess>> workers;
+    for (size_t shard = 0; shard < count; ++shard) {
+        auto shardArgs = args;
+        shardArgs.insert(shardArgs.end(), { "--worker", std::to_string(shard), std::to_string(count), folderPath.string() });
+
+        auto worker = std::make_unique<WorkerProcess>();
+        if (!worker->start(executable, shardArgs)) {
+            std::cerr << RED << "[-] Failed to start worker " << shard << RESET << '\n';
+            return {};
+        }
+        workers.push_back(std::move(worker));
+    }
+    return workers;
+}
+
+// Coordinator side: one query fanned out to every worker, results merged by build.
+bool runShardedQuery(std::vector<std::unique_ptr<WorkerProcess>>& workers, const std::string& request) {
+    using namespace std::chrono;
+    const auto start = high_resolution_clock::now();
+    beginScan();
+
+    std::vector<std::future<bool>> replies;
+    std::vector<std::vector<std::pair<ResultLine, size_t>>> records(workers.size());
+    for (size_t w = 0; w < workers.size(); ++w) {
+        replies.push_back(std::async(std::launch::async, [&, w] {
+            auto& worker = *workers[w];
+            if (!worker.alive() || !worker.send(request)) return false;
+
+            std::string header;
+            while (worker.readLine(header)) {
+                if (header == "E") return true;
+
+                std::istringstream fields(header.substr(1));
+                ResultLine result;
+                size_t missing = 0;
+                size_t length = 0;
+                if (header[0] != 'R' || !(fields >> result.build >> result.incomplete >> missing >> length)) return false;
+
+                result.line.resize(length);
+                if (!worker.readBytes(result.line.data(), length)) return false;
+                records[w].push_back({ std::move(result), missing });
+            }
+            return false;
+        }));
+    }
+
+    // Ctrl-C only flags the coordinator; pass it on so the workers return what they have.
+    bool cancelSent = false;
+    bool allWorkers = true;
+    for (auto& f : replies) {
+        while (f.wait_for(milliseconds(50)) != std::future_status::ready) {
+            if (cancelSent || !scanCancelled.load()) continue;
+            for (auto& worker : workers) {
+                if (worker->alive()) worker->send("C");
+            }
+            cancelSent = true;
+        }
+        allWorkers &= f.get();
+    }
+    endScan();
+
+    std::vector<std::pair<ResultLine, size_t>> merged;
+    for (auto& shard : records) std::move(shard.begin(), shard.end(), std::back_inserter(merged));
+    std::stable_sort(merged.begin(), merged.end(),
+                     [](const auto& a, const auto& b) { return a.first.build < b.first.build; });
+
+    bool allFound = true;
+    bool anyIncomplete = false;
+    for (const auto& [result, missing] : merged) {
+        std::cout << result.line << '\n';
+        allFound &= missing == 0;
+        anyIncomplete |= result.incomplete;
+    }
+
+    if (!allWorkers) {
+        std::cout << RED << "[-]" << RESET << " A worker stopped responding, results are missing\n";
+    }
+    // Workers only cancel when told to, so anything else cut short was the timeout.
+    if (anyIncomplete) {
+        std::cout << YELLOW << "[!]" << RESET << (scanCancelled.load() ? " Scan cancelled" : " Query timed out")
+                  << ", results are partial\n";
+    }
+
+    const auto end = high_resolution_clock::now();
+    if (!hideTime) {
+        std::cout << "\n[~] Scan completed on " << workers.size() << " workers in "
+                << duration_cast<milliseconds>(end - start).count()
+                << " ms\n";
+    }
+
+    return allFound && allWorkers && !anyIncomplete;
+}
+
+// Structured output for building offset tables: one CSV row per match and one column per
+// capture, decoded straight from the loaded .text section.
+std::string csvField(std::string_view value) {
+    if (value.find_first_of(",\"\r\n") == std::string_view::npos) return std::string(value);
+    std::string quoted = "\"";
+    for (char c : value) {
+        if (c == '"') quoted += '"';
+        quoted += c;
+    }
+    return quoted + '"';
+}
+
+// Runs `rows` over every build in parallel and prints the rows it returns in build order.
+bool exportCsv(const fs::path& folderPath, const std::string& header,
+               const std::function<std::string(const BuildImage&, bool*)>& rows) {
+    beginScan();
+
+    std::vector<ResultLine> outputBuffer;
+    std::mutex outputMutex;
+    std::vector<std::future<void>> futures;
+    for (const auto& path : listBuildFiles(folderPath)) {
+        futures.push_back(std::async(std::launch::async, [&, path] {
+            sem.acquire();
+            ResultLine result{ 0, "", scanInterrupted() };
+            if (!result.incomplete) {
+                if (const auto image = loadBuildImage(path)) {
+                    bool complete = true;
+                    result.line = rows(*image, &complete);
+                    result.build = image->buildNumber;
+                    result.incomplete = !complete;
+                }
+            }
+            sem.release();
+
+            std::lock_guard lock(outputMutex);
+            outputBuffer.push_back(std::move(result));
+        }));
+    }
+
+    for (auto& f : futures) f.get();
+    endScan();
+
+    std::sort(outputBuffer.begin(), outputBuffer.end(),
+              [](const ResultLine& a, const ResultLine& b) {
+                  return a.build < b.build;
+              });
+
+    bool allFound = true;
+    bool anyIncomplete = false;
+    std::cout << header << '\n';
+    for (const auto& result : outputBuffer) {
+        std::cout << result.line;
+        allFound &= !result.line.empty();
+        anyIncomplete |= result.incomplete;
+    }
+
+    if (anyIncomplete) {
+        std::cerr << YELLOW << "[!]" << RESET << (scanTimedOut.load() ? " Query timed out" : " Scan cancelled")
+                  << ", results are partial\n";
+    }
+
+    return allFound && !anyIncomplete;
+}
+
+bool exportPatternCsv(const fs::path& folderPath, const BytePattern& pattern, const std::vector<Capture>& captures) {
+    std::string header = "game,build,offset";
+    for (const auto& capture : captures) header += "," + csvField(capture.name);
+    if (annotateSymbols) header += ",symbol";
+
+    return exportCsv(folderPath, header, [&](const BuildImage& image, bool* complete) {
+        const auto symbols = loadBuildSymbols(image.path);
+        std::ostringstream oss;
+        for (size_t offset : searchKeptRanges(image.text(), image.textSize, pattern, skippedRanges(image), complete)) {
+            oss << csvField(image.gameName) << "," << csvField(image.build) << ",0x" << std::hex << std::uppercase << offset;
+            for (const auto& capture : captures) oss << "," << decodeCapture(image.text(), offset, capture);
+            if (annotateSymbols) oss << "," << csvField(symbolName(symbols ? &*symbols : nullptr, image.textRva, offset));
+            oss << '\n';
+        }
+        return oss.str();
+    });
+}
+
+// Signatures with a capture of the same name share its column; each chain reports the
+// matches of its winning alternative.
+bool exportSignatureCsv(const fs::path& folderPath, const SignatureDatabase& database) {
+    std::vector<std::string> columns;
+    for (size_t id = 0; id < database.size(); ++id) {
+        for (const auto& capture : database.captures(id)) {
+            if (std::find(columns.begin(), columns.end(), capture.name) == columns.end()) columns.push_back(capture.name);
+        }
+    }
+
+    std::string header = "game,build,signature,offset";
+    for (const auto& column : columns) header += "," + csvField(column);
+    if (annotateSymbols) header += ",symbol";
+
+    return exportCsv(folderPath, header, [&](const BuildImage& image, bool* complete) {
+        const auto symbols = loadBuildSymbols(image.path);
+        const auto matches =
+            searchSignaturesKeptRanges(database, image.text(), image.textSize, skippedRanges(image), complete);
+        std::vector<size_t> counts(matches.size());
+        for (size_t id = 0; id < matches.size(); ++id) counts[id] = matches[id].size();
+
+        std::ostringstream oss;
+        for (size_t head = 0; head < matches.size(); head += database.signature(head).alternatives) {
+            const auto winner = resolveChain(database, head, counts);
+            if (!winner.has_value()) continue;
+
+            const auto captures = database.captures(*winner);
+            for (size_t offset : matches[*winner]) {
+                std::vector<std::string> cells(columns.size());
+                for (const auto& capture : captures) {
+                    const size_t column = std::find(columns.begin(), columns.end(), capture.name) - columns.begin();
+                    cells[column] = decodeCapture(image.text(), offset, capture);
+                }
+
+                oss << csvField(image.gameName) << "," << csvField(image.build) << "," << csvField(database.name(*winner))
+                    << ",0x" << std::hex << std::uppercase << offset;
+                for (const auto& cell : cells) oss << "," << cell;
+                if (annotateSymbols) oss << "," << csvField(symbolName(symbols ? &*symbols : nullptr, image.textRva, offset));
+                oss << '\n';
+            }
+        }
+        return oss.str();
+    });
+}
+
+// Section alignment between two builds: a run of bytes that is identical in both,
+// possibly at a different offset.
+struct AlignedRegion {
+    size_t oldOffset;
+    size_t newOffset;
+    size_t length;
+};
+
+// Content-defined chunking: a gear hash over the last 64 bytes picks chunk boundaries,
+// so boundaries survive insertions and both sections chunk identically around shared code.
+// The gear hash only depends on a 64-byte window, which lets segments be chunked in parallel.
+constexpr size_t CDC_MIN_CHUNK = 256;
+constexpr size_t CDC_MAX_CHUNK = 16 * 1024;
+constexpr int CDC_BOUNDARY_BITS = 11; // ~2 KiB average chunks
+constexpr size_t CDC_MIN_SEGMENT = 4 << 20;
+constexpr size_t DIFF_MOVE_SLACK = 16;
+constexpr size_t REFINE_BLOCK_SIZE = 32;
+constexpr uint64_t ROLLING_HASH_BASE = 0x100000001B3ull;
+
+struct ContentChunk {
+    size_t offset;
+    size_t length;
+    uint64_t hash;
+};
+
+constexpr std::array<uint64_t, 256> makeGearTable() {
+    std::array<uint64_t, 256> table{};
+    uint64_t state = 0x2545F4914F6CDD1Dull;
+    for (auto& value : table) {
+        state += 0x9E3779B97F4A7C15ull;
+        uint64_t z = state;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        value = z ^ (z >> 31);
+    }
+    return table;
+}
+
+constexpr auto GEAR_TABLE = makeGearTable();
+
+uint64_t hashBlock(const uint8_t* data, size_t length) {
+    uint64_t hash = 0;
+    for (size_t i = 0; i < length; ++i) hash = hash * ROLLING_HASH_BASE + data[i];
+    return hash;
+}
+
+// Finds shared runs inside a pair of unmatched ranges, which happens when several edits
+// fall into neighbouring chunks: the old range is indexed in small fixed blocks and a
+// rolling hash over the new range finds them at any offset.
+void refineGap(const uint8_t* oldData, size_t oldBegin, size_t oldEnd, const uint8_t* newData, size_t newBegin,
+               size_t newEnd, std::vector<AlignedRegion>& out) {
+    if (oldEnd - oldBegin < REFINE_BLOCK_SIZE || newEnd - newBegin < REFINE_BLOCK_SIZE) return;
+
+    std::unordered_map<uint64_t, size_t> blocks;
+    for (size_t offset = oldBegin; offset + REFINE_BLOCK_SIZE <= oldEnd; offset += REFINE_BLOCK_SIZE) {
+        blocks.try_emplace(hashBlock(oldData + offset, REFINE_BLOCK_SIZE), offset);
+    }
+
+    uint64_t outFactor = 1;
+    for (size_t i = 1; i < REFINE_BLOCK_SIZE; ++i) outFactor *= ROLLING_HASH_BASE;
+
+    size_t floor = newBegin;
+    size_t i = newBegin;
+    size_t steps = 0;
+    uint64_t hash = hashBlock(newData + i, REFINE_BLOCK_SIZE);
+    while (i + REFINE_BLOCK_SIZE <= newEnd) {
+        if (++steps % SCAN_CHUNK_SIZE == 0 && scanInterrupted()) return;
+
+        const auto it = blocks.find(hash);
+        if (it != blocks.end() && std::memcmp(oldData + it->second, newData + i, REFINE_BLOCK_SIZE) == 0) {
+            size_t oldStart = it->second;
+            size_t newStart = i;
+            while (newStart > floor && oldStart > oldBegin && newData[newStart - 1] == oldData[oldStart - 1]) {
+                --newStart;
+                --oldStart;
+            }
+
+            size_t length = i - newStart + REFINE_BLOCK_SIZE;
+            while (newStart + length < newEnd && oldStart + length < oldEnd &&
+                   newData[newStart + length] == oldData[oldStart + length]) {
+                ++length;
+            }
+
+            out.push_back({ oldStart, newStart, length });
+            i = floor = newStart + length;
+            if (i + REFINE_BLOCK_SIZE <= newEnd) hash = hashBlock(newData + i, REFINE_BLOCK_SIZE);
+            continue;
+        }
+
+        if (i + REFINE_BLOCK_SIZE < newEnd) {
+            hash = (hash - newData[i] * outFactor) * ROLLING_HASH_BASE + newData[i + REFINE_BLOCK_SIZE];
+        }
+        ++i;
+    }
+}
+
+std::vector<ContentChunk> chunkContent(const uint8_t* data, size_t size) {
+    std::vector<ContentChunk> chunks;
+    if (size == 0) return chunks;
+
+    const size_t workers = std::max<size_t>(1, std::thread::hardware_concurrency());
+    const size_t segmentSize = std::max(CDC_MIN_SEGMENT, (size + workers - 1) / workers);
+    const size_t segmentCount = (size + segmentSize - 1) / segmentSize;
+
+    std::vector<std::vector<size_t>> candidates(segmentCount);
+    std::vector<std::future<void>> futures;
+    for (size_t s = 0; s < segmentCount; ++s) {
+        futures.push_back(std::async(std::launch::async, [&, s] {
+            const size_t begin = s * segmentSize;
+            const size_t end = std::min(size, begin + segmentSize);
+
+            uint64_t hash = 0;
+            for (size_t i = begin >= 64 ? begin - 64 : 0; i < begin; ++i) hash = (hash << 1) + GEAR_TABLE[data[i]];
+
+            for (size_t i = begin; i < end; ++i) {
+                if (((i - begin) & (SCAN_CHUNK_SIZE - 1)) == 0 && scanInterrupted()) return;
+
+                hash = (hash << 1) + GEAR_TABLE[data[i]];
+                if ((hash >> (64 - CDC_BOUNDARY_BITS)) == 0) candidates[s].push_back(i + 1);
+            }
+        }));
+    }
+    for (auto& f : futures) f.get();
+    if (scanInterrupted()) return {};
+
+    size_t last = 0;
+    auto cutAt = [&](size_t boundary) {
+        while (boundary - last > CDC_MAX_CHUNK) {
+            chunks.push_back({ last, CDC_MAX_CHUNK, 0 });
+            last += CDC_MAX_CHUNK;
+        }
+        chunks.push_back({ last, boundary - last, 0 });
+        last = boundary;
+    };
+    for (const auto& segment : candidates) {
+        for (size_t boundary : segment) {
+            if (boundary - last >= CDC_MIN_CHUNK && boundary < size) cutAt(boundary);
+        }
+    }
+    cutAt(size);
+
+    futures.clear();
+    const size_t perWorker = (chunks.size() + workers - 1) / workers;
+    for (size_t begin = 0; begin < chunks.size(); begin += perWorker) {
+        futures.push_back(std::async(std::launch::async, [&, begin] {
+            const size_t end = std::min(chunks.size(), begin + perWorker);
+            for (size_t c = begin; c < end; ++c) {
+                if ((c - begin) % 256 == 0 && scanInterrupted()) return;
+                chunks[c].hash = hashBytes(data + chunks[c].offset, chunks[c].length);
+            }
+        }));
+    }
+    for (auto& f : futures) f.get();
+    if (scanInterrupted()) return {};
+
+    return chunks;
+}
+
+// Aligns two sections by matching content-defined chunks, then extends every matched run
+// byte-wise into the neighbouring unmatched chunks. Returns disjoint regions sorted by
+// new offset; when interrupted, `complete` is cleared and the regions are not usable.
+std::vector<AlignedRegion> alignSections(const uint8_t* oldData, size_t oldSize, const uint8_t* newData, size_t newSize,
+                                         bool* complete = nullptr) {
+    if (complete) *complete = true;
+    auto interrupted = [complete] {
+        if (!scanInterrupted()) return false;
+        if (complete) *complete = false;
+        return true;
+    };
+
+    std::vector<AlignedRegion> regions;
+    const auto oldChunks = chunkContent(oldData, oldSize);
+    const auto newChunks = chunkContent(newData, newSize);
+    if (interrupted()) return {};
+
+    std::unordered_map<uint64_t, size_t> index;
+    index.reserve(oldChunks.size());
+    for (size_t c = 0; c < oldChunks.size(); ++c) index.try_emplace(oldChunks[c].hash, c);
+
+    for (const auto& chunk : newChunks) {
+        const auto it = index.find(chunk.hash);
+        if (it == index.end()) continue;
+
+        const auto& oldChunk = oldChunks[it->second];
+        if (oldChunk.length != chunk.length ||
+            std::memcmp(oldData + oldChunk.offset, newData + chunk.offset, chunk.length) != 0)
+            continue;
+
+        if (!regions.empty() && regions.back().newOffset + regions.back().length == chunk.offset &&
+            regions.back().oldOffset + regions.back().length == oldChunk.offset) {
+            regions.back().length += chunk.length;
+        } else {
+            regions.push_back({ oldChunk.offset, chunk.offset, chunk.length });
+        }
+    }
+
+    for (size_t k = 0; k < regions.size(); ++k) {
+        if (k % 4096 == 0 && interrupted()) return {};
+
+        auto& region = regions[k];
+        const size_t floor = k > 0 ? regions[k - 1].newOffset + regions[k - 1].length : 0;
+        while (region.newOffset > floor && region.oldOffset > 0 &&
+               newData[region.newOffset - 1] == oldData[region.oldOffset - 1]) {
+            --region.newOffset;
+            --region.oldOffset;
+            ++region.length;
+        }
+
+        const size_t ceiling = k + 1 < regions.size() ? regions[k + 1].newOffset : newSize;
+        while (region.newOffset + region.length < ceiling && region.oldOffset + region.length < oldSize &&
+               newData[region.newOffset + region.length] == oldData[region.oldOffset + region.length]) {
+            ++region.length;
+        }
+    }
+
+    // The last chunks rarely line up, so also align the common suffix of both sections.
+    const size_t tailFloorNew = regions.empty() ? 0 : regions.back().newOffset + regions.back().length;
+    const size_t tailFloorOld = regions.empty() ? 0 : regions.back().oldOffset + regions.back().length;
+    size_t suffix = 0;
+    while (suffix < newSize - tailFloorNew && suffix < oldSize - std::min(oldSize, tailFloorOld) &&
+           newData[newSize - 1 - suffix] == oldData[oldSize - 1 - suffix]) {
+        ++suffix;
+    }
+    if (suffix > 0) regions.push_back({ oldSize - suffix, newSize - suffix, suffix });
+
+    std::vector<AlignedRegion> refined;
+    size_t oldCursor = 0;
+    size_t newCursor = 0;
+    for (const auto& region : regions) {
+        if (region.oldOffset >= oldCursor) {
+            refineGap(oldData, oldCursor, region.oldOffset, newData, newCursor, region.newOffset, refined);
+        }
+        refined.push_back(region);
+        oldCursor = region.oldOffset + region.length;
+        newCursor = region.newOffset + region.length;
+    }
+    if (oldCursor < oldSize && newCursor < newSize) {
+        refineGap(oldData, oldCursor, oldSize, newData, newCursor, newSize, refined);
+    }
+    if (interrupted()) return {};
+
+    std::vector<AlignedRegion> merged;
+    for (const auto& region : refined) {
+        if (!merged.empty() && merged.back().newOffset + merged.back().length == region.newOffset &&
+            merged.back().oldOffset + merged.back().length == region.oldOffset) {
+            merged.back().length += region.length;
+        } else {
+            merged.push_back(region);
+        }
+    }
+
+    return merged;
+}
+
+// Accepts a path, a file name inside the builds folder or a bare build number.
+std::optional<fs::path> resolveBuildPath(const fs::path& folderPath, const std::string& spec) {
+    if (fs::is_regular_file(spec)) return fs::path(spec);
+    if (fs::is_regular_file(folderPath / spec)) return folderPath / spec;
+
+    for (const auto& path : listBuildFiles(folderPath)) {
+        if (extractBuildNumber(path.filename().string()) == spec) return path;
+    }
+
+    std::cerr << RED << "[-] Build not found: " << spec << RESET << '\n';
+    return std::nullopt;
+}
+
+std::vector<SignatureSource> signatureSources(const SignatureDatabase& database) {
+    std::vector<SignatureSource> sources;
+    for (size_t id = 0; id < database.size(); ++id) {
+        SignatureSource source{ std::string(database.name(id)), std::string(database.note(id)), {},
+                                database.signature(id).alternative, database.signature(id).alternatives,
+                                database.captures(id) };
+        for (uint32_t j = 0; j < database.signature(id).length; ++j) {
+            if (database.mask(id)[j]) source.pattern.push_back(database.value(id)[j]);
+            else source.pattern.push_back(std::nullopt);
+        }
+        sources.push_back(std::move(source));
+    }
+    return sources;
+}
+
+bool matchesSignatureAt(const SignatureDatabase& database, size_t id, const uint8_t* data, size_t size, size_t offset) {
+    const uint32_t length = database.signature(id).length;
+    if (offset + length > size) return false;
+
+    const uint8_t* value = database.value(id);
+    const uint8_t* mask = database.mask(id);
+    for (uint32_t j = 0; j < length; ++j) {
+        if ((data[offset + j] & mask[j]) != value[j]) return false;
+    }
+    return true;
+}
+
+// Match cache: <build>.pvmatches holds the offsets a complete revalidation found for
+// every signature, keyed by the build's size and mtime and a hash of the signature set,
+// so that the next build can be revalidated from them without rescanning this one.
+constexpr auto MATCHES_EXTENSION = ".pvmatches";
+constexpr auto MATCHES_HEADER = "PatternV matches 1";
+
+uint64_t signatureSetHash(const SignatureDatabase& database) {
+    std::string blob;
+    for (size_t id = 0; id < database.size(); ++id) {
+        const uint32_t length = database.signature(id).length;
+        blob += database.name(id);
+        blob += '\0';
+        blob.append(reinterpret_cast<const char*>(database.value(id)), length);
+        blob.append(reinterpret_cast<const char*>(database.mask(id)), length);
+    }
+    return hashBytes(reinterpret_cast<const uint8_t*>(blob.data()), blob.size());
+}
+
+std::string matchCacheKey(const fs::path& buildPath, const SignatureDatabase& database) {
+    std::error_code ec;
+    const uint64_t size = fs::file_size(buildPath, ec);
+    if (ec) return {};
+    const int64_t mtime = fs::last_write_time(buildPath, ec).time_since_epoch().count();
+    if (ec) return {};
+
+    std::ostringstream key;
+    key << size << '\t' << mtime << '\t' << std::hex << signatureSetHash(database);
+    return key.str();
+}
+
+std::optional<std::vector<std::vector<size_t>>> loadCachedMatches(const fs::path& buildPath,
+                                                                  const SignatureDatabase& database) {
+    fs::path cachePath = buildPath;
+    cachePath += MATCHES_EXTENSION;
+    std::ifstream file(cachePath);
+    std::string line;
+    if (!file || !std::getline(file, line) || line != MATCHES_HEADER) return std::nullopt;
+    const auto key = matchCacheKey(buildPath, database);
+    if (key.empty() || !std::getline(file, line) || line != key) return std::nullopt;
+
+    std::vector<std::vector<size_t>> matches(database.size());
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        size_t id = 0;
+        if (!(fields >> std::dec >> id) || id >= database.size()) return std::nullopt;
+        size_t offset = 0;
+        while (fields >> std::hex >> offset) matches[id].push_back(offset);
+    }
+    return matches;
+}
+
+template <typename Matches>
+void saveCachedMatches(const fs::path& buildPath, const SignatureDatabase& database, const Matches& matches) {
+    const auto key = matchCacheKey(buildPath, database);
+    if (key.empty()) return;
+
+    fs::path cachePath = buildPath;
+    cachePath += MATCHES_EXTENSION;
+    std::ostringstream suffix;
+    suffix << ".tmp." << std::hex << std::random_device{}() << std::random_device{}();
+    fs::path tempPath = cachePath;
+    tempPath += suffix.str();
+    {
+        std::ofstream outFile(tempPath, std::ios::trunc);
+        if (!outFile) return;
+        outFile << MATCHES_HEADER << '\n' << key << '\n';
+        for (size_t id = 0; id < matches.size(); ++id) {
+            if (matches[id].empty()) continue;
+            outFile << std::dec << id << std::hex;
+            for (size_t offset : matches[id]) outFile << ' ' << offset;
+            outFile << '\n';
+        }
+    }
+    std::error_code ec;
+    fs::rename(tempPath, cachePath, ec);
+    if (ec) fs::remove(tempPath, ec);
+}
+
+// Revalidates a signature set on a new build using the results of its predecessor,
+// read from the old build's match cache (scanned and cached once if it has none).
+// Old matches lying inside unchanged (possibly relocated) code are verified at their
+// predicted offset only. A signature is settled when all of its old matches are found
+// again there; the rest are rescanned in the changed ranges of the new build, widened
+// by their longest length. The new build's results are cached for the next revision.
+bool revalidateSignatures(const fs::path& oldPath, const fs::path& newPath, const SignatureDatabase& database) {
+    using namespace std::chrono;
+    const auto start = high_resolution_clock::now();
+    beginScan();
+
+    auto oldImage = loadBuildImage(oldPath);
+    auto newImage = loadBuildImage(newPath);
+    if (!oldImage.has_value() || !newImage.has_value()) {
+        endScan();
+        return false;
+    }
+
+    const uint8_t* oldText = oldImage->text();
+    const uint8_t* newText = newImage->text();
+    const size_t newSize = newImage->textSize;
+
+    bool complete = true;
+    auto cached = loadCachedMatches(oldPath, database);
+    if (!cached.has_value()) {
+        std::cout << YELLOW << "[!]" << RESET << " No match cache for " << oldImage->filename
+                  << ", scanning it once\n";
+        bool oldComplete = true;
+        const auto matches = searchSignatures(database, oldText, oldImage->textSize, &oldComplete);
+        if (!oldComplete) {
+            endScan();
+            std::cout << YELLOW << "[!]" << RESET << (scanTimedOut.load() ? " Query timed out" : " Scan cancelled")
+                      << ", nothing revalidated\n";
+            return false;
+        }
+        saveCachedMatches(oldPath, database, matches);
+        cached.emplace(database.size());
+        for (size_t id = 0; id < matches.size(); ++id) (*cached)[id].assign(matches[id].begin(), matches[id].end());
+    }
+    const auto& oldMatches = *cached;
+    const auto regions = alignSections(oldText, oldImage->textSize, newText, newSize, &complete);
+    if (!complete) {
+        endScan();
+        std::cout << YELLOW << "[!]" << RESET << (scanTimedOut.load() ? " Query timed out" : " Scan cancelled")
+                  << " while aligning the builds, nothing revalidated\n";
+        return false;
+    }
+
+    // Old matches of all signatures, by offset, to relocate them region by region.
+    struct OldMatch {
+        size_t offset;
+        uint32_t signature;
+        bool relocated;
+    };
+    std::vector<OldMatch> pending;
+    for (uint32_t id = 0; id < oldMatches.size(); ++id) {
+        for (size_t offset : oldMatches[id]) pending.push_back({ offset, id, false });
+    }
+    std::sort(pending.begin(), pending.end(),
+              [](const OldMatch& a, const OldMatch& b) { return a.offset < b.offset; });
+
+    std::vector<std::vector<size_t>> newMatches(database.size());
+    size_t unchangedBytes = 0;
+    for (const auto& region : regions) {
+        unchangedBytes += region.length;
+        auto it = std::lower_bound(pending.begin(), pending.end(), region.oldOffset,
+                                   [](const OldMatch& m, size_t offset) { return m.offset < offset; });
+        for (; it != pending.end() && it->offset < region.oldOffset + region.length; ++it) {
+            const size_t length = database.signature(it->signature).length;
+            if (it->offset + length > region.oldOffset + region.length) continue;
+
+            const size_t predicted = region.newOffset + (it->offset - region.oldOffset);
+            if (matchesSignatureAt(database, it->signature, newText, newSize, predicted)) {
+                newMatches[it->signature].push_back(predicted);
+                it->relocated = true;
+            }
+        }
+    }
+
+    std::vector<bool> touchesChanges(database.size());
+    for (const auto& match : pending) {
+        if (!match.relocated) touchesChanges[match.signature] = true;
+    }
+
+    // Misses: signatures with an old match that was not found at its predicted offset,
+    // or with no old match at all. Only these are looked for in the changed ranges.
+    auto sources = signatureSources(database);
+    std::vector<SignatureSource> missSources;
+    std::vector<size_t> missIds;
+    size_t maxLength = 1;
+    for (size_t id = 0; id < sources.size(); ++id) {
+        if (!touchesChanges[id] && !oldMatches[id].empty()) continue;
+        maxLength = std::max(maxLength, sources[id].pattern.size());
+        sources[id].alternative = 0;
+        sources[id].alternatives = 1;
+        missSources.push_back(std::move(sources[id]));
+        missIds.push_back(id);
+    }
+
+    // Anything not lying entirely inside one aligned region overlaps a changed range or a
+    // seam between regions, so scanning those ranges widened by maxLength - 1 is exhaustive.
+    auto insideRegion = [&regions](size_t offset, size_t length) {
+        auto it = std::upper_bound(regions.begin(), regions.end(), offset,
+                                   [](size_t value, const AlignedRegion& r) { return value < r.newOffset; });
+        if (it == regions.begin()) return false;
+        --it;
+        return offset + length <= it->newOffset + it->length;
+    };
+
+    std::vector<std::pair<size_t, size_t>> changedRanges;
+    size_t cursor = 0;
+    for (const auto& region : regions) {
+        changedRanges.push_back({ cursor, region.newOffset });
+        cursor = region.newOffset + region.length;
+    }
+    changedRanges.push_back({ cursor, newSize });
+
+    const bool fullScan = unchangedBytes < newSize / 2;
+    size_t scannedBytes = 0;
+    SignatureDatabase missDatabase;
+    if (!missSources.empty() && missDatabase.loadImage(compileSignatureDatabase(missSources))) {
+        if (fullScan) {
+            const auto matches = searchSignatures(missDatabase, newText, newSize, &complete);
+            for (size_t i = 0; i < matches.size(); ++i) {
+                newMatches[missIds[i]].assign(matches[i].begin(), matches[i].end());
+            }
+            scannedBytes = newSize;
+        } else {
+            size_t windowEnd = 0;
+            for (const auto& [changeStart, changeEnd] : changedRanges) {
+                const size_t windowStart =
+                    std::max(windowEnd, changeStart > maxLength - 1 ? changeStart - (maxLength - 1) : 0);
+                windowEnd = std::min(newSize, changeEnd + maxLength - 1);
+                if (windowStart >= windowEnd) continue;
+
+                bool windowComplete = true;
+                const auto matches =
+                    searchSignatures(missDatabase, newText + windowStart, windowEnd - windowStart, &windowComplete);
+                complete &= windowComplete;
+                scannedBytes += windowEnd - windowStart;
+
+                for (size_t i = 0; i < matches.size(); ++i) {
+                    for (size_t offset : matches[i]) {
+                        if (!insideRegion(windowStart + offset, missDatabase.signature(i).length)) {
+                            newMatches[missIds[i]].push_back(windowStart + offset);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    endScan();
+
+    std::vector<size_t> counts(database.size());
+    for (size_t id = 0; id < database.size(); ++id) {
+        auto& offsets = newMatches[id];
+        std::sort(offsets.begin(), offsets.end());
+        offsets.erase(std::unique(offsets.begin(), offsets.end()), offsets.end());
+        counts[id] = offsets.size();
+    }
+    if (complete) saveCachedMatches(newPath, database, newMatches);
+
+    std::ostringstream oss;
+    size_t found = 0;
+    size_t chains = 0;
+    size_t relocated = 0;
+    for (size_t head = 0; head < database.size(); head += database.signature(head).alternatives, ++chains) {
+        const auto winner = resolveChain(database, head, counts);
+        const size_t id = winner.value_or(head);
+        const auto& offsets = newMatches[id];
+        if (winner.has_value()) ++found;
+        if (!touchesChanges[id] && !oldMatches[id].empty()) ++relocated;
+
+        const char* status = oldMatches[id].empty() ? "new" : (touchesChanges[id] ? "changed" : "relocated");
+        if (minifiedOutput) {
+            oss << (offsets.empty() ? RED : GREEN) << (offsets.empty() ? "[-] " : "[+] ") << RESET << newImage->gameName
+                << "_" << newImage->build << " " << database.name(id) << alternativeLabel(database, id) << " " << status;
+        } else {
+            oss << "    " << (offsets.empty() ? RED : GREEN) << (offsets.empty() ? "[-]" : "[+]") << RESET << " "
+                << database.name(id) << alternativeLabel(database, id) << " [" << status << "]";
+        }
+        oss << " (" << std::dec << oldMatches[id].size() << " -> " << offsets.size() << " matches)";
+
+        if (!offsets.empty() && !countOnlyOutput) {
+            oss << ": ";
+            for (size_t i = 0; i < offsets.size(); ++i) {
+                if (i) oss << ", ";
+                oss << (minifiedOutput ? "" : YELLOW) << "0x" << std::hex << std::uppercase << offsets[i]
+                    << (minifiedOutput ? "" : RESET);
+            }
+        }
+        oss << '\n';
+    }
+
+    if (!minifiedOutput) {
+        std::cout << (found == chains ? GREEN : RED) << (found == chains ? "[+]" : "[-]") << RESET
+                  << " " << newImage->gameName << " v" << YELLOW << oldImage->build << RESET << " -> v" << YELLOW
+                  << newImage->build << RESET << ": " << found << "/" << chains << " signatures found\n";
+    }
+    std::cout << oss.str();
+
+    if (!complete) {
+        std::cout << YELLOW << "[!]" << RESET << (scanTimedOut.load() ? " Query timed out" : " Scan cancelled")
+                  << ", results are partial\n";
+    }
+
+    const auto end = high_resolution_clock::now();
+    if (!hideTime) {
+        std::cout << "\n[~] " << std::fixed << std::setprecision(1)
+                  << (newSize ? 100.0 * static_cast<double>(unchangedBytes) / static_cast<double>(newSize) : 0.0)
+                  << "% of .text unchanged (" << std::dec << regions.size() << " regions), " << relocated
+                  << " signatures relocated, " << (fullScan && scannedBytes ? "full scan of " : "rescanned ") << scannedBytes / 1024
+                  << " KB of " << newSize / 1024 << " KB in " << duration_cast<milliseconds>(end - start).count()
+                  << " ms\n";
+    }
+
+    return found == chains && complete;
+}
+
+// Prints the changed-region map between the .text sections of two builds. Regions that
+// keep their relative order (longest increasing run of old offsets) are unchanged code;
+// the remaining aligned regions moved, and the gaps between unchanged regions are
+// changed, inserted or removed ranges.
+bool diffBuilds(const fs::path& pathA, const fs::path& pathB) {
+    using namespace std::chrono;
+    const auto start = high_resolution_clock::now();
+
+    const auto imageA = loadBuildImage(pathA);
+    const auto imageB = loadBuildImage(pathB);
+    if (!imageA.has_value() || !imageB.has_value()) return false;
+
+    const auto loaded = high_resolution_clock::now();
+    beginScan();
+    bool complete = true;
+    const auto regions = alignSections(imageA->text(), imageA->textSize, imageB->text(), imageB->textSize, &complete);
+
+    // Longest increasing subsequence of old offsets, O(n log n).
+    std::vector<size_t> tails;
+    std::vector<size_t> previous(regions.size(), SIZE_MAX);
+    for (size_t k = 0; k < regions.size() && complete; ++k) {
+        if (k % 4096 == 0 && scanInterrupted()) complete = false;
+
+        auto it = std::lower_bound(tails.begin(), tails.end(), regions[k].oldOffset,
+                                   [&regions](size_t index, size_t offset) { return regions[index].oldOffset < offset; });
+        if (it != tails.begin()) previous[k] = *(it - 1);
+        if (it == tails.end()) tails.push_back(k);
+        else *it = k;
+    }
+    endScan();
+
+    if (!complete) {
+        std::cout << YELLOW << "[!]" << RESET << (scanTimedOut.load() ? " Query timed out" : " Scan cancelled")
+                  << " while aligning the builds, no diff\n";
+        return false;
+    }
+
+    std::vector<bool> inOrder(regions.size());
+    for (size_t k = tails.empty() ? SIZE_MAX : tails.back(); k != SIZE_MAX; k = previous[k]) inOrder[k] = true;
+
+    // Byte-wise extension can make neighbouring regions overlap slightly in the old
+    // section; clip them so the in-order regions tile both sections monotonically.
+    std::vector<AlignedRegion> ordered;
+    std::vector<AlignedRegion> moved;
+    for (size_t k = 0; k < regions.size(); ++k) {
+        AlignedRegion region = regions[k];
+        if (inOrder[k] && !ordered.empty()) {
+            const size_t oldEnd = ordered.back().oldOffset + ordered.back().length;
+            if (region.oldOffset < oldEnd) {
+                const size_t overlap = std::min(region.length, oldEnd - region.oldOffset);
+                region.oldOffset += overlap;
+                region.newOffset += overlap;
+                region.length -= overlap;
+            }
+        }
+        if (region.length == 0) continue;
+        (inOrder[k] ? ordered : moved).push_back(region);
+    }
+
+    auto range = [](size_t begin, size_t end) {
+        std::ostringstream oss;
+        oss << "0x" << std::hex << std::uppercase << begin << "-0x" << end << " (0x" << end - begin << ")";
+        return oss.str();
+    };
+
+    auto movedBytes = [&moved](size_t begin, size_t end, bool oldSide) {
+        size_t covered = 0;
+        for (const auto& region : moved) {
+            const size_t start = oldSide ? region.oldOffset : region.newOffset;
+            const size_t stop = start + region.length;
+            if (start < end && stop > begin) covered += std::min(end, stop) - std::max(begin, start);
+        }
+        return covered;
+    };
+
+    std::vector<std::pair<size_t, std::string>> lines;
+    size_t changed = 0, inserted = 0, removed = 0, unchangedBytes = 0;
+    size_t cursorA = 0;
+    size_t cursorB = 0;
+    auto reportGap = [&](size_t endA, size_t endB) {
+        // A few bytes next to a moved block are ambiguous extension leftovers, not edits.
+        auto hasResidue = [](size_t length, size_t covered) {
+            return length > covered && (covered == 0 || length - covered >= DIFF_MOVE_SLACK);
+        };
+        const bool hasOld = hasResidue(endA - cursorA, movedBytes(cursorA, endA, true));
+        const bool hasNew = hasResidue(endB - cursorB, movedBytes(cursorB, endB, false));
+        std::ostringstream oss;
+        if (hasOld && hasNew) {
+            ++changed;
+            oss << YELLOW << "[~]" << RESET << " changed   A " << range(cursorA, endA) << " -> B " << range(cursorB, endB);
+        } else if (hasNew) {
+            ++inserted;
+            oss << GREEN << "[+]" << RESET << " inserted  B " << range(cursorB, endB);
+        } else if (hasOld) {
+            ++removed;
+            oss << RED << "[-]" << RESET << " removed   A " << range(cursorA, endA);
+        } else {
+            return;
+        }
+        lines.push_back({ cursorB, oss.str() });
+    };
+
+    for (const auto& region : ordered) {
+        reportGap(region.oldOffset, region.newOffset);
+        unchangedBytes += region.length;
+        cursorA = region.oldOffset + region.length;
+        cursorB = region.newOffset + region.length;
+    }
+    reportGap(std::max(cursorA, imageA->textSize), std::max(cursorB, imageB->textSize));
+
+    for (const auto& region : moved) {
+        std::ostringstream oss;
+        oss << YELLOW << "[>]" << RESET << " moved     A " << range(region.oldOffset, region.oldOffset + region.length)
+            << " -> B " << range(region.newOffset, region.newOffset + region.length);
+        lines.push_back({ region.newOffset, oss.str() });
+    }
+
+    std::stable_sort(lines.begin(), lines.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+    for (const auto& line : lines) std::cout << line.second << '\n';
+
+    const auto end = high_resolution_clock::now();
+    const double seconds = duration<double>(end - loaded).count();
+    const double totalBytes = static_cast<double>(imageA->textSize + imageB->textSize);
+
+    std::cout << "\n[~] " << imageA->gameName << " v" << YELLOW << imageA->build << RESET << " -> v" << YELLOW
+              << imageB->build << RESET << ": " << std::fixed << std::setprecision(2)
+              << (imageB->textSize ? 100.0 * static_cast<double>(unchangedBytes) / static_cast<double>(imageB->textSize) : 0.0)
+              << "% unchanged, " << std::dec << changed << " changed, " << inserted << " inserted, " << removed
+              << " removed, " << moved.size() << " moved\n";
+    if (!hideTime) {
+        std::cout << "[~] Diffed " << static_cast<size_t>(totalBytes / (1024 * 1024)) << " MB in "
+                  << duration_cast<milliseconds>(end - loaded).count() << " ms ("
+                  << std::setprecision(2) << (seconds > 0 ? totalBytes / seconds / 1e9 : 0.0) << " GB/s), "
+                  << duration_cast<milliseconds>(end - start).count() << " ms including I/O\n";
+    }
+
+    return true;
+}
+
+// Loads every build of the folder, sorted by build number.
+std::vector<BuildImage> loadAllBuildImages(const fs::path& folderPath) {
+    std::vector<std::future<std::optional<BuildImage>>> futures;
+    for (const auto& path : listBuildFiles(folderPath)) {
+        futures.push_back(std::async(std::launch::async, [path] {
+            sem.acquire();
+            auto image = loadBuildImage(path);
+            sem.release();
+            return image;
+        }));
+    }
+
+    std::vector<BuildImage> images;
+    for (auto& f : futures) {
+        auto image = f.get();
+        if (image.has_value()) images.push_back(std::move(*image));
+    }
+
+    std::sort(images.begin(), images.end(),
+              [](const BuildImage& a, const BuildImage& b) { return a.buildNumber < b.buildNumber; });
+    return images;
+}
+
+struct FuzzyMatch {
+    size_t offset;
+    size_t mismatches;
+};
+
+// Positions where at most `maxMismatches` fixed bytes of the pattern differ.
+std::vector<FuzzyMatch> searchPatternMismatches(const uint8_t* data, size_t size, const BytePattern& pattern,
+                                                size_t maxMismatches, bool* complete = nullptr) {
+    std::vector<FuzzyMatch> matches;
+    if (complete) *complete = true;
+    if (size < pattern.size()) return matches;
+
+    const size_t last = size - pattern.size();
+    for (size_t chunk = 0; chunk <= last; chunk += SCAN_CHUNK_SIZE) {
+        if (scanInterrupted()) {
+            if (complete) *complete = false;
+            break;
+        }
+
+        const size_t chunkEnd = std::min(last, chunk + SCAN_CHUNK_SIZE - 1);
+        for (size_t i = chunk; i <= chunkEnd; ++i) {
+            size_t mismatches = 0;
+            for (size_t j = 0; j < pattern.size() && mismatches <= maxMismatches; ++j) {
+                if (pattern[j].has_value() && data[i + j] != pattern[j].value()) ++mismatches;
+            }
+            if (mismatches <= maxMismatches) matches.push_back({ i, mismatches });
+        }
+    }
+
+    return matches;
+}
+
+std::string formatBytePattern(const BytePattern& pattern) {
+    std::ostringstream oss;
+    for (size_t j = 0; j < pattern.size(); ++j) {
+        if (j) oss << ' ';
+        if (pattern[j].has_value()) {
+            oss << std::hex << std::uppercase << std::setw(2) << std::setfill('0') << static_cast<int>(*pattern[j]);
+        } else {
+            oss << "??";
+        }
+    }
+    return oss.str();
+}
+
+// Locates the site of `pattern` in every build (exact, or closest by Hamming distance
+// when it no longer matches), measures which bytes vary between the sites and wildcards
+// exactly those. The original and hardened patterns are then verified together with
+// the multi-pattern engine in one pass per build.
+bool hardenPattern(const fs::path& folderPath, const BytePattern& pattern) {
+    using namespace std::chrono;
+    const auto start = high_resolution_clock::now();
+    beginScan();
+
+    const auto images = loadAllBuildImages(folderPath);
+    const size_t mismatchBudget = maxMismatches ? maxMismatches : std::max<size_t>(1, countFixedBytes(pattern) / 4);
+
+    struct Site {
+        std::optional<size_t> offset;
+        size_t mismatches = 0;
+        bool ambiguous = false;
+        bool complete = true;
+    };
+    std::vector<Site> sites(images.size());
+    std::vector<std::future<void>> futures;
+    for (size_t b = 0; b < images.size(); ++b) {
+        futures.push_back(std::async(std::launch::async, [&, b] {
+            sem.acquire();
+            const auto matches = searchPatternMismatches(images[b].text(), images[b].textSize, pattern, mismatchBudget,
+                                                         &sites[b].complete);
+            sem.release();
+
+            size_t best = SIZE_MAX;
+            size_t bestCount = 0;
+            for (const auto& match : matches) {
+                if (match.mismatches < best) {
+                    best = match.mismatches;
+                    bestCount = 0;
+                    sites[b].offset = match.offset;
+                }
+                if (match.mismatches == best) ++bestCount;
+            }
+            sites[b].mismatches = best;
+            if (bestCount > 1) {
+                sites[b].ambiguous = true;
+                sites[b].offset.reset();
+            }
+        }));
+    }
+    for (auto& f : futures) f.get();
+
+    if (std::any_of(sites.begin(), sites.end(), [](const Site& site) { return !site.complete; })) {
+        endScan();
+        std::cout << YELLOW << "[!]" << RESET << (scanTimedOut.load() ? " Query timed out" : " Scan cancelled")
+                  << " while locating the sites, nothing hardened\n";
+        return false;
+    }
+
+    std::vector<std::vector<bool>> seen(pattern.size(), std::vector<bool>(256));
+    std::vector<size_t> distinct(pattern.size());
+    size_t aligned = 0, fuzzy = 0, ambiguous = 0;
+    for (size_t b = 0; b < images.size(); ++b) {
+        if (sites[b].ambiguous) ++ambiguous;
+        if (!sites[b].offset.has_value()) continue;
+
+        ++aligned;
+        if (sites[b].mismatches > 0) ++fuzzy;
+        for (size_t j = 0; j < pattern.size(); ++j) {
+            const uint8_t value = images[b].text()[*sites[b].offset + j];
+            if (!seen[j][value]) {
+                seen[j][value] = true;
+                ++distinct[j];
+            }
+        }
+    }
+
+    if (aligned == 0) {
+        endScan();
+        std::cout << RED << "[-]" << RESET << " No build has a unique site within " << mismatchBudget
+                  << " mismatches of the pattern\n";
+        return false;
+    }
+
+    BytePattern hardened = pattern;
+    std::ostringstream variability;
+    for (size_t j = 0; j < pattern.size(); ++j) {
+        if (j) variability << ' ';
+        if (!pattern[j].has_value()) {
+            variability << "??";
+            continue;
+        }
+
+        if (distinct[j] > 1) {
+            hardened[j].reset();
+        } else {
+            hardened[j] = static_cast<uint8_t>(std::find(seen[j].begin(), seen[j].end(), true) - seen[j].begin());
+        }
+
+        if (distinct[j] <= 1) variability << " .";
+        else if (distinct[j] < 10) variability << ' ' << distinct[j];
+        else variability << " +";
+    }
+
+    std::cout << "[~] Sites aligned in " << aligned << "/" << images.size() << " builds (" << fuzzy << " fuzzy, "
+              << ambiguous << " ambiguous, up to " << mismatchBudget << " mismatches)\n";
+    std::cout << "    Original:    " << formatBytePattern(pattern) << '\n';
+    std::cout << "    Variability: " << variability.str() << '\n';
+
+    if (countFixedBytes(hardened) == 0) {
+        endScan();
+        std::cout << RED << "[-]" << RESET << " No stable bytes: every fixed byte differs between the aligned builds\n";
+        return false;
+    }
+    std::cout << GREEN << "[+]" << RESET << " Hardened:    " << YELLOW << formatBytePattern(hardened) << RESET << "\n\n";
+
+    SignatureDatabase database;
+    database.loadImage(compileSignatureDatabase({ { "original", "", pattern }, { "hardened", "", hardened } }));
+
+    size_t unique = 0;
+    bool complete = true;
+    for (const auto& image : images) {
+        bool imageComplete = true;
+        const auto matches = searchSignatures(database, image.text(), image.textSize, &imageComplete);
+        complete &= imageComplete;
+        const bool isUnique = matches[1].size() == 1;
+        if (isUnique) ++unique;
+
+        if (minifiedOutput) {
+            std::cout << (isUnique ? GREEN : RED) << (isUnique ? "[+] " : "[-] ") << RESET << image.gameName << "_"
+                      << image.build << " original " << matches[0].size() << ", hardened " << matches[1].size() << '\n';
+        } else {
+            std::cout << (isUnique ? GREEN : RED) << (isUnique ? "[+]" : "[-]") << RESET << " " << image.gameName << " v"
+                      << YELLOW << image.build << RESET << ": original " << matches[0].size() << " matches, hardened "
+                      << matches[1].size() << " matches";
+            if (matches[1].size() == 1) std::cout << " at " << YELLOW << "0x" << std::hex << std::uppercase << *matches[1].begin() << std::dec << RESET;
+            std::cout << '\n';
+        }
+    }
+    endScan();
+
+    if (!complete) {
+        std::cout << YELLOW << "[!]" << RESET << (scanTimedOut.load() ? " Query timed out" : " Scan cancelled")
+                  << ", results are partial\n";
+    }
+
+    const auto end = high_resolution_clock::now();
+    std::cout << "\n[~] Hardened pattern is unique in " << unique << "/" << images.size() << " builds";
+    if (!hideTime) std::cout << " (" << duration_cast<milliseconds>(end - start).count() << " ms)";
+    std::cout << '\n';
+
+    return complete && unique == images.size();
+}
+
+// Finds the shortest sub-window of `pattern`, then the fewest fixed bytes inside it, that
+// match exactly the same sites as the full pattern in every build.
+//
+// Window phase: the first three fixed bytes from every start offset are compiled into one
+// signature set and scanned in a single pass; each start then extends its window byte by
+// byte, filtering its candidate list in memory until the candidate count equals the
+// reference count in every build (candidates always include the reference sites).
+//
+// Byte phase: by pigeonhole, any site within k mismatches of the window exactly matches
+// one of k + 1 disjoint groups of its fixed bytes, so one multi-pattern pass over those
+// groups collects every near-miss together with its (at most k) mismatching positions.
+// Any set of up to k bytes can then be tested for removal in memory.
+bool minimizePattern(const fs::path& folderPath, const BytePattern& pattern) {
+    using namespace std::chrono;
+    const auto start = high_resolution_clock::now();
+    beginScan();
+
+    const auto images = loadAllBuildImages(folderPath);
+    if (images.empty() || pattern.empty()) {
+        endScan();
+        std::cerr << "No builds to minimize against.\n";
+        return false;
+    }
+
+    // Every phase compares whole match sets, so an interrupted pass ends the run.
+    std::atomic<bool> complete = true;
+    auto scanAll = [&images, &complete](const SignatureDatabase& database) {
+        std::vector<std::vector<MatchSet>> results(images.size());
+        std::vector<std::future<void>> futures;
+        for (size_t b = 0; b < images.size(); ++b) {
+            futures.push_back(std::async(std::launch::async, [&, b] {
+                sem.acquire();
+                bool buildComplete = true;
+                results[b] = searchSignatures(database, images[b].text(), images[b].textSize, &buildComplete);
+                if (!buildComplete) complete.store(false);
+                sem.release();
+            }));
+        }
+        for (auto& f : futures) f.get();
+        return results;
+    };
+    auto stopIfInterrupted = [&complete] {
+        if (complete.load()) return false;
+        endScan();
+        std::cout << YELLOW << "[!]" << RESET << (scanTimedOut.load() ? " Query timed out" : " Scan cancelled")
+                  << ", nothing minimized\n";
+        return true;
+    };
+
+    SignatureDatabase referenceDatabase;
+    referenceDatabase.loadImage(compileSignatureDatabase({ { "reference", "", pattern } }));
+    std::vector<std::vector<size_t>> reference(images.size());
+    size_t referenceTotal = 0;
+    const auto referenceMatches = scanAll(referenceDatabase);
+    if (stopIfInterrupted()) return false;
+    for (size_t b = 0; b < images.size(); ++b) {
+        reference[b].assign(referenceMatches[b][0].begin(), referenceMatches[b][0].end());
+        referenceTotal += reference[b].size();
+    }
+
+    // Window phase.
+    std::vector<SignatureSource> seeds;
+    std::vector<std::pair<size_t, size_t>> seedWindows;
+    for (size_t s = 0; s < pattern.size(); ++s) {
+        if (!pattern[s].has_value()) continue;
+
+        size_t e = s;
+        size_t fixed = 0;
+        while (e < pattern.size() && fixed < 3) {
+            if (pattern[e].has_value()) ++fixed;
+            ++e;
+        }
+        seeds.push_back({ std::to_string(s), "", BytePattern(pattern.begin() + s, pattern.begin() + e) });
+        seedWindows.push_back({ s, e });
+    }
+
+    SignatureDatabase seedDatabase;
+    seedDatabase.loadImage(compileSignatureDatabase(seeds));
+    const auto seedMatches = scanAll(seedDatabase);
+    if (stopIfInterrupted()) return false;
+
+    size_t bestStart = 0;
+    size_t bestEnd = pattern.size();
+    size_t windowVariants = 0;
+    for (size_t w = 0; w < seedWindows.size(); ++w) {
+        const auto [s, e0] = seedWindows[w];
+        std::vector<std::vector<size_t>> candidates(images.size());
+        for (size_t b = 0; b < images.size(); ++b) candidates[b].assign(seedMatches[b][w].begin(), seedMatches[b][w].end());
+
+        for (size_t e = e0; e <= pattern.size() && e - s < bestEnd - bestStart; ++e) {
+            if (e > e0 && pattern[e - 1].has_value()) {
+                const uint8_t value = *pattern[e - 1];
+                for (size_t b = 0; b < images.size(); ++b) {
+                    auto& list = candidates[b];
+                    list.erase(std::remove_if(list.begin(), list.end(), [&](size_t p) {
+                        return p + (e - s) > images[b].textSize || images[b].text()[p + e - 1 - s] != value;
+                    }), list.end());
+                }
+            }
+            ++windowVariants;
+
+            bool equal = true;
+            for (size_t b = 0; b < images.size() && equal; ++b) equal = candidates[b].size() == reference[b].size();
+            if (equal) {
+                bestStart = s;
+                bestEnd = e;
+                break;
+            }
+        }
+    }
+
+    BytePattern window(pattern.begin() + bestStart, pattern.begin() + bestEnd);
+    std::cout << "[~] Reference: " << referenceTotal << " matches across " << images.size() << " builds\n";
+    std::cout << "[~] Shortest window: bytes " << bestStart << ".." << bestEnd - 1 << " (" << window.size() << " of "
+              << pattern.size() << " bytes, " << windowVariants << " windows evaluated)\n";
+
+    // Byte phase.
+    size_t removedTotal = 0;
+    size_t passes = 0;
+    size_t byteVariants = 0;
+    while (true) {
+        std::vector<size_t> fixedPositions;
+        for (size_t j = 0; j < window.size(); ++j) {
+            if (window[j].has_value()) fixedPositions.push_back(j);
+        }
+
+        const size_t maxRemovals = std::min<size_t>(4, fixedPositions.size() / 3 > 0 ? fixedPositions.size() / 3 - 1 : 0);
+        if (maxRemovals == 0) break;
+
+        std::vector<SignatureSource> groups;
+        const size_t groupCount = maxRemovals + 1;
+        for (size_t g = 0; g < groupCount; ++g) {
+            BytePattern group(window.size());
+            const size_t begin = g * fixedPositions.size() / groupCount;
+            const size_t end = (g + 1) * fixedPositions.size() / groupCount;
+            for (size_t k = begin; k < end; ++k) group[fixedPositions[k]] = window[fixedPositions[k]];
+            groups.push_back({ std::to_string(g), "", std::move(group) });
+        }
+
+        SignatureDatabase groupDatabase;
+        groupDatabase.loadImage(compileSignatureDatabase(groups));
+        const auto groupMatches = scanAll(groupDatabase);
+        if (stopIfInterrupted()) return false;
+        ++passes;
+
+        std::vector<std::vector<size_t>> nearMisses;
+        for (size_t b = 0; b < images.size(); ++b) {
+            std::vector<size_t> positions;
+            for (const auto& set : groupMatches[b]) positions.insert(positions.end(), set.begin(), set.end());
+            std::sort(positions.begin(), positions.end());
+            positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+
+            for (size_t p : positions) {
+                std::vector<size_t> mismatches;
+                for (size_t j : fixedPositions) {
+                    if (images[b].text()[p + j] != *window[j]) {
+                        mismatches.push_back(j);
+                        if (mismatches.size() > maxRemovals) break;
+                    }
+                }
+                if (!mismatches.empty() && mismatches.size() <= maxRemovals) nearMisses.push_back(std::move(mismatches));
+            }
+        }
+        std::sort(nearMisses.begin(), nearMisses.end());
+        nearMisses.erase(std::unique(nearMisses.begin(), nearMisses.end()), nearMisses.end());
+
+        // Common bytes add the least selectivity, so try those first.
+        auto order = fixedPositions;
+        std::stable_sort(order.begin(), order.end(), [&window](size_t a, size_t b) {
+            return byteCommonness(*window[a]) > byteCommonness(*window[b]);
+        });
+
+        // Wildcarding j is unsafe if some near-miss mismatches only on removed bytes and j.
+        std::vector<bool> removed(window.size());
+        size_t removedCount = 0;
+        for (size_t j : order) {
+            if (removedCount == maxRemovals) break;
+
+            ++byteVariants;
+            const bool safe = std::none_of(nearMisses.begin(), nearMisses.end(), [&](const std::vector<size_t>& miss) {
+                return std::all_of(miss.begin(), miss.end(), [&](size_t k) { return k == j || removed[k]; });
+            });
+            if (safe) {
+                removed[j] = true;
+                ++removedCount;
+            }
+        }
+
+        for (size_t j = 0; j < window.size(); ++j) {
+            if (removed[j]) window[j].reset();
+        }
+        removedTotal += removedCount;
+        if (removedCount < maxRemovals) break;
+    }
+
+    size_t trimStart = 0;
+    while (trimStart < window.size() && !window[trimStart].has_value()) ++trimStart;
+    size_t trimEnd = window.size();
+    while (trimEnd > trimStart && !window[trimEnd - 1].has_value()) --trimEnd;
+    const BytePattern minimized(window.begin() + trimStart, window.begin() + trimEnd);
+    const size_t offset = bestStart + trimStart;
+
+    std::cout << "[~] Byte minimization: " << removedTotal << " fixed bytes wildcarded in " << passes << " passes ("
+              << byteVariants << " variants evaluated)\n";
+    std::cout << GREEN << "[+]" << RESET << " Minimized: " << YELLOW << formatBytePattern(minimized) << RESET
+              << " (" << countFixedBytes(minimized) << " of " << countFixedBytes(pattern) << " fixed bytes, match offset +"
+              << offset << ")\n";
+
+    SignatureDatabase verifyDatabase;
+    verifyDatabase.loadImage(compileSignatureDatabase({ { "minimized", "", minimized } }));
+    const auto verification = scanAll(verifyDatabase);
+    if (stopIfInterrupted()) return false;
+    endScan();
+
+    size_t identical = 0;
+    for (size_t b = 0; b < images.size(); ++b) {
+        std::vector<size_t> expected;
+        for (size_t p : reference[b]) expected.push_back(p + offset);
+        const std::vector<size_t> actual(verification[b][0].begin(), verification[b][0].end());
+        if (actual == expected) ++identical;
+        else std::cout << RED << "[-]" << RESET << " Match set differs in " << images[b].gameName << " v" << images[b].build << '\n';
+    }
+
+    const auto end = high_resolution_clock::now();
+    std::cout << (identical == images.size() ? GREEN : RED) << (identical == images.size() ? "[+]" : "[-]") << RESET
+              << " Identical match sets in " << identical << "/" << images.size() << " builds";
+    if (!hideTime) std::cout << " (" << duration_cast<milliseconds>(end - start).count() << " ms)";
+    std::cout << '\n';
+
+    return identical == images.size();
+}
+
+// Approximate search under edit distance (insertions, deletions and substitutions) with
+// Myers' bit-parallel algorithm in Hyyrö's block formulation: the DP column is kept as
+// vertical +1/-1 delta bit-vectors, 64 pattern bytes per word, and one text byte advances
+// all words with a handful of word operations. Wildcards match every byte for free.
+struct ApproximateMatch {
+    size_t offset;
+    size_t length;
+    size_t distance;
+};
+
+class MyersMatcher {
+public:
+    explicit MyersMatcher(const BytePattern& pattern)
+        : length(pattern.size()), words((pattern.size() + 63) / 64), peq(256 * words) {
+        for (size_t j = 0; j < length; ++j) {
+            const uint64_t bit = uint64_t(1) << (j % 64);
+            for (size_t c = 0; c < 256; ++c) {
+                if (!pattern[j].has_value() || *pattern[j] == c) peq[c * words + j / 64] |= bit;
+            }
+        }
+    }
+
+    // Reports (end offset, distance) for every end position in [begin, end) whose best
+    // alignment costs at most maxDistance. Starts from `begin - warmup`, which must be at
+    // least length + maxDistance bytes back for the scores to be exact.
+    bool search(const uint8_t* data, size_t begin, size_t end, size_t warmup, size_t maxDistance,
+                std::vector<std::pair<size_t, size_t>>& hits) const {
+        std::vector<uint64_t> pv(words, ~uint64_t(0));
+        std::vector<uint64_t> mv(words, 0);
+        const uint64_t lastBit = uint64_t(1) << ((length - 1) % 64);
+        size_t score = length;
+
+        for (size_t i = begin - warmup; i < end; ++i) {
+            if ((i & (SCAN_CHUNK_SIZE - 1)) == 0 && scanInterrupted()) return false;
+
+            const uint64_t* eqs = &peq[data[i] * words];
+            int carry = 0; // horizontal delta entering the word from above: +1, 0 or -1
+            for (size_t w = 0; w < words; ++w) {
+                uint64_t eq = eqs[w];
+                const uint64_t xv = eq | mv[w];
+                if (carry < 0) eq |= 1;
+                const uint64_t xh = (((eq & pv[w]) + pv[w]) ^ pv[w]) | eq;
+                uint64_t ph = mv[w] | ~(xh | pv[w]);
+                uint64_t mh = pv[w] & xh;
+
+                const uint64_t high = w + 1 == words ? lastBit : uint64_t(1) << 63;
+                const int out = (ph & high) ? 1 : ((mh & high) ? -1 : 0);
+
+                ph <<= 1;
+                mh <<= 1;
+                if (carry < 0) mh |= 1;
+                else if (carry > 0) ph |= 1;
+
+                pv[w] = mh | ~(xv | ph);
+                mv[w] = ph & xv;
+                carry = out;
+            }
+
+            score += carry;
+            if (i >= begin && score <= maxDistance) hits.push_back({ i, score });
+        }
+
+        return true;
+    }
+
+private:
+    size_t length;
+    size_t words;
+    std::vector<uint64_t> peq;
+};
+
+// Edit distance of `pattern` against text ending exactly at `end`, over all start offsets;
+// returns the start of the cheapest (and, on ties, longest-overlapping) alignment.
+size_t locateAlignmentStart(const uint8_t* data, size_t end, const BytePattern& pattern, size_t maxDistance,
+                            size_t distance) {
+    const size_t m = pattern.size();
+    const size_t span = std::min(end + 1, m + maxDistance);
+    std::vector<size_t> row(span + 1), next(span + 1);
+
+    // Both strings reversed from `end`: row[j] = cost of the pattern suffix so far against
+    // the last j text bytes.
+    for (size_t j = 0; j <= span; ++j) row[j] = j;
+    for (size_t i = 1; i <= m; ++i) {
+        const auto& expected = pattern[m - i];
+        next[0] = i;
+        for (size_t j = 1; j <= span; ++j) {
+            const bool same = !expected.has_value() || *expected == data[end + 1 - j];
+            next[j] = std::min({ row[j - 1] + (same ? 0 : 1), row[j] + 1, next[j - 1] + 1 });
+        }
+        std::swap(row, next);
+    }
+
+    auto skew = [m](size_t j) { return j > m ? j - m : m - j; };
+    size_t best = 0;
+    for (size_t j = 1; j <= span; ++j) {
+        if (row[j] == distance && (best == 0 || skew(j) < skew(best))) best = j;
+    }
+    return end + 1 - (best == 0 ? std::min(m, span) : best);
+}
+
+std::vector<ApproximateMatch> searchApproximate(const uint8_t* data, size_t size, const BytePattern& pattern,
+                                                size_t maxDistance, bool* complete) {
+    std::vector<ApproximateMatch> matches;
+    *complete = true;
+    if (pattern.empty() || size == 0) return matches;
+
+    const MyersMatcher matcher(pattern);
+    const size_t workers = std::max<size_t>(1, std::thread::hardware_concurrency());
+    const size_t chunkSize = std::max(SCAN_CHUNK_SIZE, (size + workers - 1) / workers);
+    const size_t warmup = pattern.size() + maxDistance;
+
+    std::vector<std::vector<std::pair<size_t, size_t>>> hits((size + chunkSize - 1) / chunkSize);
+    std::vector<std::future<bool>> futures;
+    for (size_t c = 0; c < hits.size(); ++c) {
+        futures.push_back(std::async(std::launch::async, [&, c] {
+            const size_t begin = c * chunkSize;
+            const size_t end = std::min(size, begin + chunkSize);
+            return matcher.search(data, begin, end, std::min(begin, warmup), maxDistance, hits[c]);
+        }));
+    }
+    for (auto& f : futures) *complete &= f.get();
+
+    // A true occurrence shows up as a run of adjacent end positions; keep the best end of
+    // every run.
+    std::optional<std::pair<size_t, size_t>> best;
+    size_t lastEnd = 0;
+    auto flush = [&] {
+        if (!best.has_value()) return;
+        const size_t start = locateAlignmentStart(data, best->first, pattern, maxDistance, best->second);
+        matches.push_back({ start, best->first + 1 - start, best->second });
+        best.reset();
+    };
+    for (const auto& chunkHits : hits) {
+        for (const auto& hit : chunkHits) {
+            if (best.has_value() && hit.first != lastEnd + 1) flush();
+            if (!best.has_value() || hit.second < best->second) best = hit;
+            lastEnd = hit.first;
+        }
+    }
+    flush();
+
+    return matches;
+}
+
+// Needle search for whole blobs (a function body copied from another build). Every run of
+// REFINE_BLOCK_SIZE fixed bytes in the needle is indexed by its hash; one rolling hash
+// over the haystack finds where those blocks occur and each hit votes for the needle start
+// it implies. Only starts backed by enough blocks to stay within the mismatch budget are
+// compared in full, so the cost is linear in the haystack whatever the needle's length.
+struct NeedleIndex {
+    std::unordered_map<uint64_t, std::vector<uint32_t>> blocks; // block hash -> needle offsets
+    std::vector<uint64_t> filter = std::vector<uint64_t>(1024); // top 16 hash bits seen
+    size_t blockCount = 0;
+};
+
+NeedleIndex indexNeedle(const BytePattern& needle) {
+    NeedleIndex index;
+    std::vector<uint8_t> block(REFINE_BLOCK_SIZE);
+    size_t run = 0;
+    for (size_t j = 0; j < needle.size(); ++j) {
+        run = needle[j].has_value() ? run + 1 : 0;
+        if (run < REFINE_BLOCK_SIZE) continue;
+
+        const size_t offset = j + 1 - REFINE_BLOCK_SIZE;
+        for (size_t b = 0; b < REFINE_BLOCK_SIZE; ++b) block[b] = *needle[offset + b];
+        run = 0;
+
+        // Padding and fill runs occur all over the haystack and would only add noise.
+        if (std::all_of(block.begin(), block.end(), [&](uint8_t value) { return value == block[0]; })) continue;
+
+        const uint64_t hash = hashBlock(block.data(), REFINE_BLOCK_SIZE);
+        index.blocks[hash].push_back(static_cast<uint32_t>(offset));
+        index.filter[hash >> 54] |= uint64_t(1) << ((hash >> 48) & 63);
+        ++index.blockCount;
+    }
+    return index;
+}
+
+std::vector<ApproximateMatch> searchNeedle(const uint8_t* data, size_t size, const BytePattern& needle,
+                                           const NeedleIndex& index, size_t maxMismatches, bool* complete) {
+    std::vector<ApproximateMatch> matches;
+    *complete = true;
+    if (needle.size() > size || index.blockCount == 0) return matches;
+
+    const size_t workers = std::max<size_t>(1, std::thread::hardware_concurrency());
+    const size_t positions = size - REFINE_BLOCK_SIZE + 1;
+    const size_t chunkSize = std::max(SCAN_CHUNK_SIZE, (positions + workers - 1) / workers);
+    uint64_t outFactor = 1;
+    for (size_t i = 1; i < REFINE_BLOCK_SIZE; ++i) outFactor *= ROLLING_HASH_BASE;
+
+    std::vector<std::vector<size_t>> votes((positions + chunkSize - 1) / chunkSize);
+    std::vector<std::future<bool>> futures;
+    for (size_t c = 0; c < votes.size(); ++c) {
+        futures.push_back(std::async(std::launch::async, [&, c] {
+            const size_t begin = c * chunkSize;
+            const size_t end = std::min(positions, begin + chunkSize);
+            uint64_t hash = hashBlock(data + begin, REFINE_BLOCK_SIZE);
+            for (size_t i = begin; i < end; ++i) {
+                if ((i & (SCAN_CHUNK_SIZE - 1)) == 0 && scanInterrupted()) return false;
+                if (i > begin) hash = (hash - data[i - 1] * outFactor) * ROLLING_HASH_BASE + data[i + REFINE_BLOCK_SIZE - 1];
+                if (!(index.filter[hash >> 54] & (uint64_t(1) << ((hash >> 48) & 63)))) continue;
+
+                const auto it = index.blocks.find(hash);
+                if (it == index.blocks.end()) continue;
+                for (uint32_t offset : it->second) {
+                    if (offset > i || i - offset + needle.size() > size) continue;
+                    votes[c].push_back(i - offset);
+                }
+            }
+            return true;
+        }));
+    }
+    for (auto& f : futures) *complete &= f.get();
+
+    std::vector<size_t> candidates;
+    for (const auto& chunkVotes : votes) candidates.insert(candidates.end(), chunkVotes.begin(), chunkVotes.end());
+    std::sort(candidates.begin(), candidates.end());
+
+    // Each differing byte breaks at most one indexed block; hash collisions are caught by the
+    // full comparison below.
+    const size_t requiredVotes = index.blockCount > maxMismatches ? index.blockCount - maxMismatches : 1;
+    for (size_t i = 0; i < candidates.size();) {
+        size_t j = i;
+        while (j < candidates.size() && candidates[j] == candidates[i]) ++j;
+
+        if (j - i >= requiredVotes) {
+            const uint8_t* site = data + candidates[i];
+            size_t mismatches = 0;
+            for (size_t k = 0; k < needle.size() && mismatches <= maxMismatches; ++k) {
+                if (needle[k].has_value() && site[k] != *needle[k]) ++mismatches;
+            }
+            if (mismatches <= maxMismatches) matches.push_back({ candidates[i], needle.size(), mismatches });
+        }
+        i = j;
+    }
+
+    return matches;
+}
+
+std::optional<BytePattern> loadNeedle(const fs::path& needlePath, const fs::path& maskPath) {
+    const auto bytes = readFile(needlePath);
+    if (bytes.empty()) return std::nullopt;
+
+    std::vector<uint8_t> mask;
+    if (!maskPath.empty()) {
+        mask = readFile(maskPath);
+        if (mask.size() != bytes.size()) {
+            std::cerr << RED << "[-] The needle mask must be as long as the needle (" << bytes.size() << " bytes)" << RESET << "\n";
+            return std::nullopt;
+        }
+    }
+
+    BytePattern needle(bytes.size());
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        if (mask.empty() || mask[i] != 0) needle[i] = bytes[i];
+    }
+    return needle;
+}
+
+// Shared driver of the approximate modes: `search` returns the sites found in one .text
+// section and `unit` names what their distance counts.
+bool scanDirectoryApproximate(const fs::path& folderPath,
+                              const std::function<std::vector<ApproximateMatch>(const uint8_t*, size_t, bool*)>& search,
+                              const char* unit) {
+    using namespace std::chrono;
+    const auto start = high_resolution_clock::now();
+    beginScan();
+
+    auto buildFiles = listBuildFiles(folderPath);
+    std::sort(buildFiles.begin(), buildFiles.end(), [](const fs::path& a, const fs::path& b) {
+        return parseBuildNumber(extractBuildNumber(a.filename().string()).value_or("0")) <
+               parseBuildNumber(extractBuildNumber(b.filename().string()).value_or("0"));
+    });
+
+    // Builds are scanned one at a time across all cores while the next one is read.
+    bool allFound = true;
+    bool anyIncomplete = false;
+    std::future<std::optional<BuildImage>> nextImage;
+    if (!buildFiles.empty()) nextImage = std::async(std::launch::async, loadBuildImage, buildFiles[0]);
+
+    for (size_t b = 0; b < buildFiles.size(); ++b) {
+        const auto image = nextImage.get();
+        if (b + 1 < buildFiles.size()) nextImage = std::async(std::launch::async, loadBuildImage, buildFiles[b + 1]);
+        if (!image.has_value()) continue;
+
+        bool complete = true;
+        const auto matches = search(image->text(), image->textSize, &complete);
+        anyIncomplete |= !complete;
+        allFound &= !matches.empty();
+
+        std::ostringstream oss;
+        if (minifiedOutput) {
+            oss << (matches.empty() ? RED : GREEN) << (matches.empty() ? "[-] " : "[+] ") << RESET << image->gameName << "_"
+                << image->build << " (" << matches.size() << " matches)";
+        } else if (matches.empty()) {
+            oss << RED << "[-]" << RESET << " Pattern not found in " << image->gameName << " v" << YELLOW << image->build << RESET;
+        } else {
+            oss << GREEN << "[+]" << RESET << " Pattern found in " << image->gameName << " v" << YELLOW << image->build
+                << RESET << " (" << matches.size() << " matches)";
+        }
+
+        if (!matches.empty() && !countOnlyOutput) {
+            oss << ": ";
+            for (size_t i = 0; i < matches.size(); ++i) {
+                if (i) oss << ", ";
+                oss << (minifiedOutput ? "" : YELLOW) << "0x" << std::hex << std::uppercase << matches[i].offset
+                    << (minifiedOutput ? "" : RESET) << std::dec << " (" << matches[i].distance << " " << unit << ", "
+                    << matches[i].length << " bytes)";
+            }
+        }
+        if (!complete) oss << YELLOW << " (incomplete)" << RESET;
+        std::cout << oss.str() << std::endl;
+
+        if (scanInterrupted()) break;
+    }
+    if (nextImage.valid()) nextImage.wait();
+    endScan();
+
+    if (anyIncomplete) {
+        std::cout << YELLOW << "[!]" << RESET << (scanTimedOut.load() ? " Query timed out" : " Scan cancelled")
+                  << ", results are partial\n";
+    }
+
+    const auto end = high_resolution_clock::now();
+    if (!hideTime) {
+        std::cout << "\n[~] Scan completed in "
+                << duration_cast<milliseconds>(end - start).count()
+                << " ms\n";
+    }
+
+    return allFound && !anyIncomplete;
+}
+
+bool scanEditDistance(const fs::path& folderPath, const BytePattern& pattern) {
+    return scanDirectoryApproximate(folderPath, [&](const uint8_t* data, size_t size, bool* complete) {
+        return searchApproximate(data, size, pattern, maxEditDistance, complete);
+    }, "edits");
+}
+
+bool scanNeedleFile(const fs::path& folderPath, const fs::path& needlePath, const fs::path& maskPath) {
+    const auto needle = loadNeedle(needlePath, maskPath);
+    if (!needle.has_value()) return false;
+
+    const auto index = indexNeedle(*needle);
+    if (index.blockCount == 0) {
+        std::cerr << RED << "[-] The needle has no run of " << REFINE_BLOCK_SIZE << " fixed bytes to index" << RESET << "\n";
+        return false;
+    }
+
+    // Unless given, tolerate about one differing byte in 16, enough for relocated
+    // displacements in a copied function body.
+    const size_t budget = maxMismatches ? maxMismatches : countFixedBytes(*needle) / 16;
+    return scanDirectoryApproximate(folderPath, [&](const uint8_t* data, size_t size, bool* complete) {
+        return searchNeedle(data, size, *needle, index, budget, complete);
+    }, "mismatches");
+}
+
+// Server mode (--serve <port>): the builds stay resident and clients on localhost send
+// one query per line. Every query is split into per-build, per-chunk scan tasks that a
+// shared pool of scan threads takes from a fair scheduler:
+//   - interactive queries always run before batch ones (strict priority classes);
+//   - within a class, clients share the scan threads by weighted fair queuing, each task
+//     costing its chunk size divided by the client's weight;
+//   - a client never has more than --client-concurrency tasks running at once, nor more
+//     than --client-memory MB of results held for its pending queries.
+// FIND queries of one class arriving within --coalesce-window of each other are merged
+// into a single multi-pattern job, so that concurrent lookups share one pass over memory.
+//
+// Protocol, one command per line; each query answers with its result lines and then
+// `END <builds> <ms>` or `ERR <reason>`:
+//   HELLO <client> [weight]          name this connection's client (shared quotas)
+//   FIND <interactive|batch> <pattern>
+//   SIGS <interactive|batch> <signature file>
+//   QUIT
+constexpr size_t SERVER_TASK_BYTES = 8 << 20;
+constexpr size_t SERVER_MAX_LINE = 1 << 20;
+constexpr size_t SERVER_COALESCE_LIMIT = 256;
+constexpr auto SERVER_METRICS_INTERVAL = std::chrono::seconds(10);
+constexpr auto SERVER_METRICS_READ_TIMEOUT = std::chrono::milliseconds(1000);
+
+#ifdef _WIN32
+using SocketHandle = SOCKET;
+constexpr SocketHandle INVALID_SOCKET_HANDLE = INVALID_SOCKET;
+void closeSocket(SocketHandle socket) { closesocket(socket); }
+#else
+using SocketHandle = int;
+constexpr SocketHandle INVALID_SOCKET_HANDLE = -1;
+void closeSocket(SocketHandle socket) { ::close(socket); }
+#endif
+
+class SocketStream {
+public:
+    explicit SocketStream(SocketHandle socket) : socket(socket) {}
+
+    bool readLine(std::string& line) {
+        line.clear();
+        while (true) {
+            for (; bufferPos < bufferEnd; ++bufferPos) {
+                if (buffer[bufferPos] == '\n') {
+                    ++bufferPos;
+                    if (!line.empty() && line.back() == '\r') line.pop_back();
+                    return true;
+                }
+                if (line.size() >= SERVER_MAX_LINE) return false;
+                line += buffer[bufferPos];
+            }
+
+            const auto count = recv(socket, buffer.data(), static_cast<int>(buffer.size()), 0);
+            if (count <= 0) return false;
+            bufferPos = 0;
+            bufferEnd = static_cast<size_t>(count);
+        }
+    }
+
+    bool send(const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            const auto count = ::send(socket, data.data() + sent, static_cast<int>(data.size() - sent), 0);
+            if (count <= 0) return false;
+            sent += static_cast<size_t>(count);
+        }
+        return true;
+    }
+
+private:
+    SocketHandle socket;
+    std::array<char, 16 * 1024> buffer{};
+    size_t bufferPos = 0;
+    size_t bufferEnd = 0;
+};
+
+enum class QueryClass { Interactive, Batch };
+
+struct ServerClient {
+    std::string name;
+    double weight = 1.0;
+    size_t running = 0;            // tasks in flight, guarded by the scheduler
+    std::atomic<size_t> memory{ 0 }; // result bytes held for its pending queries
+};
+
+// Log-linear latency histogram in the style of HdrHistogram: exact below 16 us, then 16
+// sub-buckets per power of two (about 6% relative error) up to the full 64-bit range.
+// Recording is a few relaxed atomic adds, so scan and connection threads share it freely.
+class LatencyHistogram {
+public:
+    void record(uint64_t micros) {
+        buckets[bucketOf(micros)].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(micros, std::memory_order_relaxed);
+    }
+
+    uint64_t total() const { return count.load(std::memory_order_relaxed); }
+    uint64_t totalMicros() const { return sum.load(std::memory_order_relaxed); }
+
+    // Upper bound of the bucket holding the q-quantile, in microseconds.
+    uint64_t quantile(double q) const {
+        const uint64_t samples = total();
+        if (samples == 0) return 0;
+        const auto rank = static_cast<uint64_t>(std::ceil(q * static_cast<double>(samples)));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+            seen += buckets[i].load(std::memory_order_relaxed);
+            if (seen >= std::max<uint64_t>(rank, 1)) return bucketUpper(i);
+        }
+        return bucketUpper(BUCKET_COUNT - 1);
+    }
+
+private:
+    static constexpr int SUB_BITS = 4;
+    static constexpr size_t BUCKET_COUNT = size_t(64 - SUB_BITS + 1) << SUB_BITS;
+
+    static size_t bucketOf(uint64_t value) {
+        if (value < (1ull << SUB_BITS)) return static_cast<size_t>(value);
+        const int exponent = std::bit_width(value) - 1 - SUB_BITS;
+        return (size_t(exponent + 1) << SUB_BITS) + ((value >> exponent) & ((1ull << SUB_BITS) - 1));
+    }
+
+    static uint64_t bucketUpper(size_t index) {
+        if (index < (1ull << SUB_BITS)) return index;
+        const size_t exponent = (index >> SUB_BITS) - 1;
+        const uint64_t mantissa = (index & ((1ull << SUB_BITS) - 1)) | (1ull << SUB_BITS);
+        return ((mantissa + 1) << exponent) - 1;
+    }
+
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets{};
+    std::atomic<uint64_t> count{ 0 };
+    std::atomic<uint64_t> sum{ 0 };
+};
+
+// Server counters, updated with relaxed atomics on the hot path and read by
+// --metrics-port / --metrics-file in the Prometheus text format.
+struct ServerMetrics {
+    std::atomic<uint64_t> queries[2][2]{};  // [class][FIND, SIGS]
+    std::atomic<uint64_t> failedQueries{ 0 };
+    std::atomic<uint64_t> coalescedQueries{ 0 }; // FIND queries that shared a pass with others
+    std::atomic<uint64_t> scannedBytes{ 0 };
+    std::atomic<uint64_t> sigdbCacheHits{ 0 };
+    std::atomic<uint64_t> sigdbCacheMisses{ 0 };
+    std::atomic<int64_t> queuedTasks{ 0 };
+    std::atomic<int64_t> runningTasks{ 0 };
+    std::atomic<int64_t> heldResultBytes{ 0 };
+    std::atomic<int64_t> connections{ 0 };
+    uint64_t residentBytes = 0;
+    std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+    LatencyHistogram latency[2]; // per class
+};
+
+ServerMetrics serverMetrics;
+
+std::string formatServerMetrics() {
+    const auto& m = serverMetrics;
+    const char* classNames[] = { "interactive", "batch" };
+    const char* commandNames[] = { "find", "sigs" };
+    auto load = [](const auto& value) { return value.load(std::memory_order_relaxed); };
+
+    std::ostringstream oss;
+    oss << "# HELP patternv_queries_total Queries answered, by class and command.\n"
+        << "# TYPE patternv_queries_total counter\n";
+    for (int c = 0; c < 2; ++c) {
+        for (int k = 0; k < 2; ++k) {
+            oss << "patternv_queries_total{class=\"" << classNames[c] << "\",command=\"" << commandNames[k] << "\"} "
+                << load(m.queries[c][k]) << '\n';
+        }
+    }
+
+    oss << "# HELP patternv_query_latency_seconds Query latency from request to last result line.\n"
+        << "# TYPE patternv_query_latency_seconds summary\n";
+    for (int c = 0; c < 2; ++c) {
+        for (double q : { 0.5, 0.9, 0.99 }) {
+            oss << "patternv_query_latency_seconds{class=\"" << classNames[c] << "\",quantile=\"" << q << "\"} "
+                << m.latency[c].quantile(q) / 1e6 << '\n';
+        }
+        oss << "patternv_query_latency_seconds_sum{class=\"" << classNames[c] << "\"} " << m.latency[c].totalMicros() / 1e6 << '\n'
+            << "patternv_query_latency_seconds_count{class=\"" << classNames[c] << "\"} " << m.latency[c].total() << '\n';
+    }
+
+    auto metric = [&](const char* name, const char* type, const char* help, auto value) {
+        oss << "# HELP " << name << ' ' << help << "\n# TYPE " << name << ' ' << type << '\n' << name << ' ' << value << '\n';
+    };
+    metric("patternv_failed_queries_total", "counter", "Queries answered with ERR.", load(m.failedQueries));
+    metric("patternv_coalesced_queries_total", "counter", "FIND queries merged into a shared scan.", load(m.coalescedQueries));
+    metric("patternv_scanned_bytes_total", "counter", "Bytes of .text scanned by the scan threads.", load(m.scannedBytes));
+    metric("patternv_sigdb_cache_hits_total", "counter", "SIGS queries served from a cached database.", load(m.sigdbCacheHits));
+    metric("patternv_sigdb_cache_misses_total", "counter", "SIGS queries that loaded their database.", load(m.sigdbCacheMisses));
+    metric("patternv_queued_tasks", "gauge", "Scan tasks waiting for a scan thread.", load(m.queuedTasks));
+    metric("patternv_running_tasks", "gauge", "Scan tasks being scanned.", load(m.runningTasks));
+    metric("patternv_connections", "gauge", "Open client connections.", load(m.connections));
+    metric("patternv_held_result_bytes", "gauge", "Encoded results held for pending queries.", load(m.heldResultBytes));
+    metric("patternv_resident_bytes", "gauge", "Bytes of .text kept resident.", m.residentBytes);
+    metric("patternv_uptime_seconds", "gauge", "Seconds since the server started.",
+           std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - m.started).count());
+    return oss.str();
+}
+
+// A query served by a scan job and the slice of the job's match sets that answers it.
+struct ScanRequester {
+    std::shared_ptr<ServerClient> client;
+    size_t firstSet = 0;
+    size_t setCount = 1;
+    std::atomic<size_t> heldMemory{ 0 };
+    std::atomic<bool> overQuota{ false };
+};
+
+// One scan over every resident build: a single pattern, a signature set, or several
+// coalesced FIND patterns compiled into one database with a match set per requester.
+struct ScanJob {
+    QueryClass queryClass = QueryClass::Interactive;
+    BytePattern pattern;
+    std::shared_ptr<const SignatureDatabase> database;
+    std::vector<BytePattern> coalesced;
+    size_t overlap = 0; // longest pattern - 1, so that chunks miss no match
+    size_t setCount = 1;
+    std::vector<std::unique_ptr<ScanRequester>> requesters; // scheduled as the first one
+
+    struct Task {
+        size_t build;
+        size_t begin;
+        size_t end;
+    };
+    std::vector<Task> tasks;
+    std::vector<std::vector<MatchSet>> results; // per task, one set per pattern
+    std::atomic<size_t> remaining{ 0 };
+    std::promise<void> done;
+    std::shared_future<void> finished = done.get_future().share();
+};
+
+class QueryScheduler {
+public:
+    QueryScheduler(const std::vector<BuildImage>& images, size_t workers, size_t clientConcurrency, size_t clientMemory)
+        : images(images), clientConcurrency(clientConcurrency), clientMemory(clientMemory) {
+        for (const auto& image : images) skipped.push_back(skippedRanges(image));
+        for (size_t i = 0; i < workers; ++i) threads.emplace_back([this] { workerLoop(); });
+    }
+
+    ~QueryScheduler() {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& thread : threads) thread.join();
+    }
+
+    // Splits the job into chunk tasks and queues them on the flow of its first requester,
+    // weighted by all of its requesters. Ranges left out by --skip-opaque get no task.
+    void submit(const std::shared_ptr<ScanJob>& job) {
+        for (size_t b = 0; b < images.size(); ++b) {
+            forEachKeptRange(skipped[b], images[b].textSize, [&](size_t keptBegin, size_t keptEnd) {
+                for (size_t begin = keptBegin; begin < keptEnd; begin += SERVER_TASK_BYTES) {
+                    job->tasks.push_back({ b, begin, std::min(keptEnd, begin + SERVER_TASK_BYTES) });
+                }
+            });
+        }
+        job->results.resize(job->tasks.size());
+        job->remaining = job->tasks.size();
+        if (job->tasks.empty()) {
+            job->done.set_value();
+            return;
+        }
+
+        double weight = 0;
+        for (const auto& requester : job->requesters) weight += requester->client->weight;
+
+        {
+            std::lock_guard lock(mutex);
+            auto& flow = flows[{ static_cast<int>(job->queryClass), job->requesters.front()->client.get() }];
+            for (size_t t = 0; t < job->tasks.size(); ++t) {
+                const double cost = static_cast<double>(job->tasks[t].end - job->tasks[t].begin) / weight;
+                flow.lastFinish = std::max(virtualTime, flow.lastFinish) + cost;
+                flow.tasks.push_back({ job, t, flow.lastFinish });
+            }
+        }
+        serverMetrics.queuedTasks.fetch_add(static_cast<int64_t>(job->tasks.size()), std::memory_order_relaxed);
+        wake.notify_all();
+    }
+
+private:
+    struct QueuedTask {
+        std::shared_ptr<ScanJob> job;
+        size_t index;
+        double finishTag;
+    };
+
+    struct Flow {
+        std::deque<QueuedTask> tasks;
+        double lastFinish = 0;
+    };
+
+    // Highest class first, then the smallest finish tag among clients under quota.
+    std::optional<QueuedTask> nextTask() {
+        for (int queryClass : { static_cast<int>(QueryClass::Interactive), static_cast<int>(QueryClass::Batch) }) {
+            auto best = flows.end();
+            for (auto it = flows.lower_bound({ queryClass, nullptr }); it != flows.end() && it->first.first == queryClass; ++it) {
+                if (it->first.second->running >= clientConcurrency) continue;
+                if (best == flows.end() || it->second.tasks.front().finishTag < best->second.tasks.front().finishTag) best = it;
+            }
+            if (best == flows.end()) continue;
+
+            QueuedTask task = std::move(best->second.tasks.front());
+            best->second.tasks.pop_front();
+            virtualTime = task.finishTag;
+            ++best->first.second->running;
+            serverMetrics.queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+            serverMetrics.runningTasks.fetch_add(1, std::memory_order_relaxed);
+            if (best->second.tasks.empty()) flows.erase(best);
+            return task;
+        }
+        return std::nullopt;
+    }
+
+    void workerLoop() {
+        while (true) {
+            std::optional<QueuedTask> task;
+            {
+                std::unique_lock lock(mutex);
+                wake.wait(lock, [&] { return stopping || (task = nextTask()).has_value(); });
+                if (!task.has_value()) return;
+            }
+
+            runTask(*task->job, task->index);
+
+            {
+                std::lock_guard lock(mutex);
+                --task->job->requesters.front()->client->running;
+            }
+            serverMetrics.runningTasks.fetch_sub(1, std::memory_order_relaxed);
+            wake.notify_all();
+            if (--task->job->remaining == 0) task->job->done.set_value();
+        }
+    }
+
+    void runTask(ScanJob& job, size_t index) {
+        if (std::all_of(job.requesters.begin(), job.requesters.end(),
+                        [](const auto& requester) { return requester->overQuota.load(); }))
+            return;
+
+        const auto& task = job.tasks[index];
+        const auto& image = images[task.build];
+        const size_t searchEnd = std::min(image.textSize, task.end + job.overlap);
+        const uint8_t* data = image.text() + task.begin;
+
+        serverMetrics.scannedBytes.fetch_add(searchEnd - task.begin, std::memory_order_relaxed);
+        std::vector<MatchSet> found;
+        if (job.database) found = searchSignatures(*job.database, data, searchEnd - task.begin);
+        else found.push_back(searchAllPatternOffsets(data, searchEnd - task.begin, job.pattern));
+
+        // Matches starting in the overlap belong to the next chunk.
+        auto& results = job.results[index];
+        for (const auto& set : found) {
+            results.emplace_back();
+            for (size_t offset : set) {
+                if (offset >= task.end - task.begin) break;
+                results.back().push_back(task.begin + offset);
+            }
+        }
+
+        for (auto& requester : job.requesters) {
+            size_t bytes = 0;
+            for (size_t s = requester->firstSet; s < requester->firstSet + requester->setCount; ++s) {
+                bytes += results[s].encodedSize();
+            }
+            requester->heldMemory += bytes;
+            serverMetrics.heldResultBytes.fetch_add(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+            if ((requester->client->memory += bytes) > clientMemory) requester->overQuota = true;
+        }
+    }
+
+    const std::vector<BuildImage>& images;
+    std::vector<std::vector<TextRange>> skipped; // per build, by --skip-opaque
+    size_t clientConcurrency;
+    size_t clientMemory;
+    std::map<std::pair<int, ServerClient*>, Flow> flows;
+    double virtualTime = 0;
+    bool stopping = false;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<std::thread> threads;
+};
+
+// Gathers the FIND queries of one class that arrive while a batch is open. The first
+// query opens the batch, waits out the window, then submits the batch as one job; every
+// query waits for that job and reads back its own match set.
+class QueryCoalescer {
+public:
+    QueryCoalescer(QueryScheduler& scheduler, std::chrono::milliseconds window) : scheduler(scheduler), window(window) {}
+
+    // Returns the job answering the query and the caller's requester index in it.
+    std::pair<std::shared_ptr<ScanJob>, size_t> find(const std::shared_ptr<ServerClient>& client, QueryClass queryClass,
+                                                     BytePattern pattern) {
+        std::shared_ptr<ScanJob> job;
+        size_t index = 0;
+        bool opened = false;
+        {
+            std::lock_guard lock(mutex);
+            auto& batch = open[static_cast<int>(queryClass)];
+            if (!batch) {
+                batch = std::make_shared<ScanJob>();
+                batch->queryClass = queryClass;
+                opened = true;
+            }
+            job = batch;
+            index = job->requesters.size();
+
+            auto requester = std::make_unique<ScanRequester>();
+            requester->client = client;
+            requester->firstSet = index;
+            job->requesters.push_back(std::move(requester));
+            job->coalesced.push_back(std::move(pattern));
+            if (job->coalesced.size() >= SERVER_COALESCE_LIMIT) batch.reset();
+        }
+
+        if (opened) {
+            std::this_thread::sleep_for(window);
+            {
+                std::lock_guard lock(mutex);
+                auto& batch = open[static_cast<int>(queryClass)];
+                if (batch == job) batch.reset();
+            }
+            prepare(*job);
+            if (job->coalesced.size() > 1) {
+                serverMetrics.coalescedQueries.fetch_add(job->coalesced.size(), std::memory_order_relaxed);
+            }
+            scheduler.submit(job);
+        }
+        return { job, index };
+    }
+
+private:
+    // A lone pattern keeps the single-pattern search; several become one database.
+    static void prepare(ScanJob& job) {
+        if (job.coalesced.size() == 1) {
+            job.pattern = job.coalesced.front();
+            job.overlap = job.pattern.size() - 1;
+            return;
+        }
+
+        std::vector<SignatureSource> sources;
+        for (const auto& pattern : job.coalesced) {
+            sources.push_back({ {}, {}, pattern });
+            job.overlap = std::max(job.overlap, pattern.size() - 1);
+        }
+        auto database = std::make_shared<SignatureDatabase>();
+        database->loadImage(compileSignatureDatabase(sources));
+        job.database = std::move(database);
+        job.setCount = job.coalesced.size();
+    }
+
+    QueryScheduler& scheduler;
+    std::chrono::milliseconds window;
+    std::mutex mutex;
+    std::shared_ptr<ScanJob> open[2];
+};
+
+struct ServerState {
+    std::vector<BuildImage> images;
+    std::vector<std::optional<SymbolTable>> symbols; // per build, by --symbols
+    std::unique_ptr<QueryScheduler> scheduler;
+    std::unique_ptr<QueryCoalescer> coalescer;
+    std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<ServerClient>> clients;
+    std::unordered_map<std::string, std::shared_ptr<const SignatureDatabase>> databases;
+};
+
+std::shared_ptr<ServerClient> serverClient(ServerState& state, const std::string& name, double weight) {
+    std::lock_guard lock(state.mutex);
+    auto& client = state.clients[name];
+    if (!client) {
+        client = std::make_shared<ServerClient>();
+        client->name = name;
+    }
+    if (weight > 0) client->weight = weight;
+    return client;
+}
+
+// Merges the chunk results of a finished job per build and formats the requester's sets
+// like a CLI scan.
+std::string formatJobResults(const ServerState& state, const ScanJob& job, const ScanRequester& requester) {
+    std::ostringstream oss;
+    size_t task = 0;
+    for (size_t b = 0; b < state.images.size(); ++b) {
+        const auto& image = state.images[b];
+        const auto* symbols = state.symbols[b] ? &*state.symbols[b] : nullptr;
+        std::vector<MatchSet> sets(requester.setCount);
+        for (; task < job.tasks.size() && job.tasks[task].build == b; ++task) {
+            if (job.results[task].empty()) continue;
+            for (size_t s = 0; s < requester.setCount; ++s) {
+                for (size_t offset : job.results[task][requester.firstSet + s]) sets[s].push_back(offset);
+            }
+        }
+
+        if (job.database && job.coalesced.empty()) {
+            size_t missing = 0;
+            oss << formatSignatureResults(*job.database, image.gameName, image.build, sets, true, missing, symbols,
+                                          image.textRva) << '\n';
+        } else {
+            oss << formatPatternResult(image.gameName, image.build, sets[0], countOnlyOutput, true, symbols,
+                                       image.textRva) << '\n';
+        }
+    }
+    return oss.str();
+}
+
+void serveConnection(SocketHandle socket, ServerState& state, size_t connectionId) {
+    SocketStream stream(socket);
+    auto client = serverClient(state, "connection-" + std::to_string(connectionId), 0);
+    serverMetrics.connections.fetch_add(1, std::memory_order_relaxed);
+
+    std::string line;
+    while (stream.readLine(line)) {
+        std::istringstream request(line);
+        std::string command;
+        request >> command;
+
+        if (command == "QUIT") break;
+        if (command == "HELLO") {
+            std::string name;
+            double weight = 0;
+            request >> name >> weight;
+            if (name.empty()) {
+                stream.send("ERR usage: HELLO <client> [weight]\n");
+                continue;
+            }
+            client = serverClient(state, name, weight);
+            stream.send("OK\n");
+            continue;
+        }
+        if (command != "FIND" && command != "SIGS") {
+            stream.send("ERR unknown command\n");
+            continue;
+        }
+
+        std::string className;
+        request >> className;
+        std::string argument;
+        std::getline(request >> std::ws, argument);
+        if ((className != "interactive" && className != "batch") || argument.empty()) {
+            stream.send("ERR usage: " + command + " <interactive|batch> <" +
+                        (command == "FIND" ? "pattern" : "signature file") + ">\n");
+            continue;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto queryClass = className == "interactive" ? QueryClass::Interactive : QueryClass::Batch;
+        std::shared_ptr<ScanJob> job;
+        size_t index = 0;
+
+        if (command == "FIND") {
+            auto pattern = parseBytePattern(argument);
+            if (countFixedBytes(pattern) == 0) {
+                serverMetrics.failedQueries.fetch_add(1, std::memory_order_relaxed);
+                stream.send("ERR invalid pattern\n");
+                continue;
+            }
+            std::tie(job, index) = state.coalescer->find(client, queryClass, std::move(pattern));
+        } else {
+            job = std::make_shared<ScanJob>();
+            job->queryClass = queryClass;
+            job->requesters.push_back(std::make_unique<ScanRequester>());
+            job->requesters.front()->client = client;
+
+            {
+                std::lock_guard lock(state.mutex);
+                auto it = state.databases.find(argument);
+                if (it != state.databases.end()) job->database = it->second;
+            }
+            (job->database ? serverMetrics.sigdbCacheHits : serverMetrics.sigdbCacheMisses).fetch_add(1, std::memory_order_relaxed);
+            if (!job->database) {
+                auto loaded = loadSignatureDatabase(argument);
+                if (!loaded.has_value()) {
+                    serverMetrics.failedQueries.fetch_add(1, std::memory_order_relaxed);
+                    stream.send("ERR cannot load signature file\n");
+                    continue;
+                }
+                job->database = std::make_shared<const SignatureDatabase>(std::move(*loaded));
+                std::lock_guard lock(state.mutex);
+                state.databases.emplace(argument, job->database);
+            }
+            job->setCount = job->database->size();
+            job->requesters.front()->setCount = job->setCount;
+            for (size_t id = 0; id < job->database->size(); ++id) {
+                job->overlap = std::max<size_t>(job->overlap, job->database->signature(id).length - 1);
+            }
+            state.scheduler->submit(job);
+        }
+
+        job->finished.wait();
+
+        const auto& requester = *job->requesters[index];
+        const bool overQuota = requester.overQuota.load();
+        const auto response = overQuota ? std::string() : formatJobResults(state, *job, requester);
+        client->memory -= requester.heldMemory.load();
+        serverMetrics.heldResultBytes.fetch_sub(static_cast<int64_t>(requester.heldMemory.load()), std::memory_order_relaxed);
+
+        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        if (overQuota) {
+            serverMetrics.failedQueries.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            serverMetrics.queries[static_cast<int>(queryClass)][command == "SIGS"].fetch_add(1, std::memory_order_relaxed);
+            serverMetrics.latency[static_cast<int>(queryClass)].record(static_cast<uint64_t>(elapsed.count()));
+        }
+
+        if (overQuota) {
+            if (!stream.send("ERR memory quota exceeded\n")) break;
+        } else if (!stream.send(response + "END " + std::to_string(state.images.size()) + " " +
+                                std::to_string(elapsed.count() / 1000) + "\n")) {
+            break;
+        }
+    }
+
+    serverMetrics.connections.fetch_sub(1, std::memory_order_relaxed);
+    closeSocket(socket);
+}
+
+SocketHandle openListener(uint16_t port) {
+    const SocketHandle listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener == INVALID_SOCKET_HANDLE) {
+        std::cerr << RED << "[-] Failed to create a server socket" << RESET << '\n';
+        return INVALID_SOCKET_HANDLE;
+    }
+
+    const int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, 64) != 0) {
+        std::cerr << RED << "[-] Failed to listen on 127.0.0.1:" << port << RESET << '\n';
+        closeSocket(listener);
+        return INVALID_SOCKET_HANDLE;
+    }
+    return listener;
+}
+
+// Answers every connection with the current metrics as a minimal HTTP response, which is
+// all a Prometheus scrape needs. The request is only drained, for at most
+// SERVER_METRICS_READ_TIMEOUT, so a client that never sends one can't stall the others.
+void serveMetrics(SocketHandle listener) {
+    while (true) {
+        const SocketHandle connection = accept(listener, nullptr, nullptr);
+        if (connection == INVALID_SOCKET_HANDLE) continue;
+
+#ifdef _WIN32
+        const DWORD timeout = static_cast<DWORD>(SERVER_METRICS_READ_TIMEOUT.count());
+#else
+        const timeval timeout{ static_cast<time_t>(SERVER_METRICS_READ_TIMEOUT.count() / 1000),
+                               static_cast<suseconds_t>(SERVER_METRICS_READ_TIMEOUT.count() % 1000 * 1000) };
+#endif
+        setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+
+        char request[1024];
+        recv(connection, request, sizeof(request), 0);
+        const auto body = formatServerMetrics();
+        SocketStream(connection).send("HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " +
+                                      std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body);
+        closeSocket(connection);
+    }
+}
+
+// Writes the metrics file at startup and then every SERVER_METRICS_INTERVAL, through a
+// rename so that readers never see a partial dump.
+void dumpMetrics(const fs::path& filePath) {
+    for (bool first = true; true; first = false) {
+        if (!first) std::this_thread::sleep_for(SERVER_METRICS_INTERVAL);
+
+        fs::path tempPath = filePath;
+        tempPath += ".tmp";
+        {
+            std::ofstream outFile(tempPath, std::ios::trunc);
+            if (!outFile) {
+                std::cerr << RED << "[-] Failed to write metrics to: " << tempPath << RESET << '\n';
+                continue;
+            }
+            outFile << formatServerMetrics();
+        }
+        std::error_code ec;
+        fs::rename(tempPath, filePath, ec);
+    }
+}
+
+bool runServer(const fs::path& folderPath, uint16_t port, size_t clientConcurrency, size_t clientMemoryMb,
+               std::chrono::milliseconds coalesceWindow, std::optional<uint16_t> metricsPort, const fs::path& metricsFile) {
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        std::cerr << RED << "[-] WSAStartup failed" << RESET << '\n';
+        return false;
+    }
+#else
+    std::signal(SIGPIPE, SIG_IGN);
+#endif
+
+    // Queries are bounded by quotas here, not by the CLI timeout.
+    queryTimeout = std::chrono::milliseconds(0);
+
+    ServerState state;
+    state.images = loadAllBuildImages(folderPath);
+    if (state.images.empty()) {
+        std::cerr << RED << "[-] No builds to serve in: " << folderPath << RESET << '\n';
+        return false;
+    }
+    for (const auto& image : state.images) state.symbols.push_back(loadBuildSymbols(image.path));
+
+    const size_t workers = std::max<size_t>(1, std::thread::hardware_concurrency());
+    if (clientConcurrency == 0) clientConcurrency = std::max<size_t>(1, workers / 2);
+    state.scheduler = std::make_unique<QueryScheduler>(state.images, workers, clientConcurrency, clientMemoryMb << 20);
+    state.coalescer = std::make_unique<QueryCoalescer>(*state.scheduler, coalesceWindow);
+
+    const SocketHandle listener = openListener(port);
+    if (listener == INVALID_SOCKET_HANDLE) return false;
+
+    if (metricsPort.has_value()) {
+        const SocketHandle metricsListener = openListener(*metricsPort);
+        if (metricsListener == INVALID_SOCKET_HANDLE) return false;
+        std::thread(serveMetrics, metricsListener).detach();
+        std::cout << GREEN << "[+]" << RESET << " Metrics on http://127.0.0.1:" << *metricsPort << "/metrics" << std::endl;
+    }
+    if (!metricsFile.empty()) std::thread(dumpMetrics, metricsFile).detach();
+
+    size_t residentBytes = 0;
+    for (const auto& image : state.images) residentBytes += image.textSize;
+    serverMetrics.residentBytes = residentBytes;
+    std::cout << GREEN << "[+]" << RESET << " Serving " << state.images.size() << " builds ("
+              << residentBytes / (1024 * 1024) << " MB of .text) on 127.0.0.1:" << port << " with " << workers
+              << " scan threads, " << clientConcurrency << " per client" << std::endl;
+
+    size_t connectionId = 0;
+    while (true) {
+        const SocketHandle connection = accept(listener, nullptr, nullptr);
+        if (connection == INVALID_SOCKET_HANDLE) continue;
+        std::thread(serveConnection, connection, std::ref(state), ++connectionId).detach();
+    }
+}
+
+void extractTextSections(const fs::path& folderPath) {
+    for (const auto& entry : fs::directory_iterator(folderPath)) {
+        if (!entry.is_regular_file() || entry.path().extension() != TARGET_EXTENSION_EXE)
+            continue;
+
+        const auto buffer = readFile(entry.path());
         if (buffer.empty())
             continue;
 
@@ -347,23 +5870,151 @@ void extractTextSections(const fs::path& folderPath) {
     }
 }
 
+// Reads the decimal value of a numeric flag, rejecting anything that isn't a whole
+// non-negative number that fits in T.
+template <typename T>
+bool parseFlagNumber(const std::string& flag, const std::string& text, T& value) {
+    const char* end = text.data() + text.size();
+    const auto result = std::from_chars(text.data(), end, value);
+    if (text.empty() || result.ec != std::errc() || result.ptr != end) {
+        std::cerr << flag << " needs a non-negative number, got '" << text << "'.\n";
+        return false;
+    }
+    return true;
+}
+
+bool checkPort(const std::string& flag, size_t port) {
+    if (port >= 1 && port <= 65535) return true;
+    std::cerr << flag << " needs a port between 1 and 65535.\n";
+    return false;
+}
+
 int main(int argc, char* argv[])
 {
     fs::path folderPath = "Builds/";
     std::string argPattern;
 
     bool extractMode = false;
+    bool hardenMode = false;
+    bool minimizeMode = false;
+    std::string needlePath;
+    std::string needleMaskPath;
+    fs::path signaturePath;
+    fs::path compileInput;
+    fs::path compileOutput;
+    std::string revalidateOld;
+    std::string revalidateNew;
+    std::string diffA;
+    std::string diffB;
+    fs::path symbolsInput;
+    std::string symbolsBuild;
+    std::string publishName;
+    std::string attachName;
+    size_t workerCount = 0;
+    std::optional<uint16_t> servePort;
+    size_t clientConcurrency = 0;
+    size_t clientMemoryMb = 512;
+    std::chrono::milliseconds coalesceWindow(2);
+    std::optional<uint16_t> metricsPort;
+    fs::path metricsFile;
+    std::optional<std::pair<size_t, size_t>> workerShard;
 
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
         if (arg == "--no-color") {
             useColors = false;
+        } else if (arg == "--skip-opaque") {
+            skipOpaque = true;
+        } else if (arg == "--layout" && i + 1 < argc) {
+            const std::string layout = argv[++i];
+            if (layout == "file") imageLayout = ImageLayout::File;
+            else if (layout == "memory") imageLayout = ImageLayout::Memory;
+            else if (layout != "auto") {
+                std::cerr << RED << "[-] Unknown layout: " << layout << " (expected auto, file or memory)" << RESET << '\n';
+                return 1;
+            }
+        } else if (arg == "--no-manifest") {
+            useManifest = false;
         } else if (arg == "--extract-text") {
             extractMode = true;
         } else if (arg == "--hide-time") {
             hideTime = true;
         } else if (arg == "--minified") {
             minifiedOutput = true;
+        } else if (arg == "--count-only") {
+            countOnlyOutput = true;
+        } else if (arg == "--publish-corpus" && i + 1 < argc) {
+            publishName = argv[++i];
+        } else if (arg == "--attach" && i + 1 < argc) {
+            attachName = argv[++i];
+        } else if (arg == "--serve" && i + 1 < argc) {
+            size_t port = 0;
+            if (!parseFlagNumber(arg, argv[++i], port) || !checkPort(arg, port)) return 1;
+            servePort = static_cast<uint16_t>(port);
+        } else if (arg == "--client-concurrency" && i + 1 < argc) {
+            if (!parseFlagNumber(arg, argv[++i], clientConcurrency)) return 1;
+        } else if (arg == "--client-memory" && i + 1 < argc) {
+            if (!parseFlagNumber(arg, argv[++i], clientMemoryMb)) return 1;
+        } else if (arg == "--metrics-port" && i + 1 < argc) {
+            size_t port = 0;
+            if (!parseFlagNumber(arg, argv[++i], port) || !checkPort(arg, port)) return 1;
+            metricsPort = static_cast<uint16_t>(port);
+        } else if (arg == "--metrics-file" && i + 1 < argc) {
+            metricsFile = argv[++i];
+        } else if (arg == "--coalesce-window" && i + 1 < argc) {
+            size_t milliseconds = 0;
+            if (!parseFlagNumber(arg, argv[++i], milliseconds)) return 1;
+            coalesceWindow = std::chrono::milliseconds(milliseconds);
+        } else if (arg == "--workers" && i + 1 < argc) {
+            if (!parseFlagNumber(arg, argv[++i], workerCount)) return 1;
+        } else if (arg == "--worker" && i + 2 < argc) {
+            size_t shard = 0, shardCount = 0;
+            if (!parseFlagNumber(arg, argv[++i], shard) || !parseFlagNumber(arg, argv[++i], shardCount)) return 1;
+            workerShard = { shard, shardCount };
+        } else if (arg == "--profile") {
+            profileSignatures = true;
+        } else if (arg == "--csv") {
+            csvOutput = true;
+        } else if (arg == "--estimate-threshold" && i + 1 < argc) {
+            if (!parseFlagNumber(arg, argv[++i], estimateThreshold)) return 1;
+        } else if (arg == "--sigs" && i + 1 < argc) {
+            signaturePath = argv[++i];
+        } else if (arg == "--compile-sigs" && i + 2 < argc) {
+            compileInput = argv[++i];
+            compileOutput = argv[++i];
+        } else if (arg == "--revalidate" && i + 2 < argc) {
+            revalidateOld = argv[++i];
+            revalidateNew = argv[++i];
+        } else if (arg == "--symbols") {
+            annotateSymbols = true;
+        } else if (arg == "--import-symbols" && i + 2 < argc) {
+            symbolsInput = argv[++i];
+            symbolsBuild = argv[++i];
+        } else if (arg == "--diff" && i + 2 < argc) {
+            diffA = argv[++i];
+            diffB = argv[++i];
+        } else if (arg == "--locality") {
+            localitySearch = true;
+        } else if (arg == "--locality-window" && i + 1 < argc) {
+            if (!parseFlagNumber(arg, argv[++i], localityWindow)) return 1;
+        } else if (arg == "--prove-unique") {
+            proveUnique = true;
+        } else if (arg == "--harden") {
+            hardenMode = true;
+        } else if (arg == "--minimize") {
+            minimizeMode = true;
+        } else if (arg == "--edit-distance" && i + 1 < argc) {
+            if (!parseFlagNumber(arg, argv[++i], maxEditDistance)) return 1;
+        } else if (arg == "--needle-file" && i + 1 < argc) {
+            needlePath = argv[++i];
+        } else if (arg == "--needle-mask" && i + 1 < argc) {
+            needleMaskPath = argv[++i];
+        } else if (arg == "--max-mismatches" && i + 1 < argc) {
+            if (!parseFlagNumber(arg, argv[++i], maxMismatches)) return 1;
+        } else if (arg == "--timeout" && i + 1 < argc) {
+            size_t milliseconds = 0;
+            if (!parseFlagNumber(arg, argv[++i], milliseconds)) return 1;
+            queryTimeout = std::chrono::milliseconds(milliseconds);
         } else if (folderPath == "Builds/") {
             folderPath = arg; 
         } else if (argPattern.empty()) {
@@ -371,14 +6022,173 @@ int main(int argc, char* argv[])
         }
     }
 
+    std::signal(SIGINT, handleInterrupt);
+
+    // An attached corpus only serves plain pattern and --sigs scans: the other modes read
+    // build files and would take the pattern for the builds folder, and the corpus keeps
+    // no opaque ranges for --skip-opaque or section RVAs for --symbols.
+    if (!attachName.empty()) {
+        const std::pair<bool, const char*> folderModes[] = {
+            { extractMode, "--extract-text" }, { hardenMode, "--harden" }, { minimizeMode, "--minimize" },
+            { !needlePath.empty(), "--needle-file" }, { !diffA.empty(), "--diff" },
+            { !revalidateOld.empty(), "--revalidate" }, { !symbolsInput.empty(), "--import-symbols" },
+            { !publishName.empty(), "--publish-corpus" }, { workerCount > 0, "--workers" },
+            { servePort.has_value(), "--serve" }, { csvOutput, "--csv" }, { maxEditDistance > 0, "--edit-distance" },
+            { localitySearch, "--locality" }, { skipOpaque, "--skip-opaque" }, { annotateSymbols, "--symbols" },
+        };
+        for (const auto& [enabled, flag] : folderModes) {
+            if (!enabled) continue;
+            std::cerr << "--attach can't be combined with " << flag << ".\n";
+            return 1;
+        }
+    }
+
+    // Workers answer plain pattern and --sigs queries only; the other modes would be
+    // dropped from the request and come back as plain exact-match results.
+    if (workerCount > 0) {
+        const std::pair<bool, const char*> unshardedModes[] = {
+            { extractMode, "--extract-text" }, { !compileInput.empty(), "--compile-sigs" },
+            { hardenMode, "--harden" }, { minimizeMode, "--minimize" }, { !needlePath.empty(), "--needle-file" },
+            { !diffA.empty(), "--diff" }, { !revalidateOld.empty(), "--revalidate" },
+            { !symbolsInput.empty(), "--import-symbols" }, { !publishName.empty(), "--publish-corpus" },
+            { servePort.has_value(), "--serve" }, { csvOutput, "--csv" }, { maxEditDistance > 0, "--edit-distance" },
+            { localitySearch, "--locality" }, { profileSignatures, "--profile" },
+        };
+        for (const auto& [enabled, flag] : unshardedModes) {
+            if (!enabled) continue;
+            std::cerr << "--workers can't be combined with " << flag << ".\n";
+            return 1;
+        }
+    }
+
+    // Only the modes that scan the whole folder use the manifest. Workers read the one
+    // their coordinator has just brought up to date and never rewrite it.
+    const bool scansFolder = attachName.empty() && !extractMode && compileInput.empty() && symbolsInput.empty() &&
+                             diffA.empty() && revalidateOld.empty();
+    if (useManifest && scansFolder && fs::is_directory(folderPath)) {
+        buildManifest.open(folderPath, !workerShard.has_value());
+    }
+
+    if (workerShard.has_value()) {
+        return runWorker(folderPath, workerShard->first, workerShard->second);
+    }
+
     if (extractMode) {
         extractTextSections(folderPath);
         return 0;
     }
 
+    if (!compileInput.empty()) {
+        return compileSignatureFile(compileInput, compileOutput) ? 0 : 1;
+    }
+
+    if (servePort.has_value()) {
+        return runServer(folderPath, *servePort, clientConcurrency, clientMemoryMb, coalesceWindow, metricsPort, metricsFile) ? 0 : 1;
+    }
+
+    if (!publishName.empty()) {
+        return publishCorpus(folderPath, publishName) ? 0 : 1;
+    }
+
+    std::vector<std::unique_ptr<WorkerProcess>> workers;
+    if (workerCount > 0) {
+        workers = startWorkers(currentExecutable(argv[0]), fs::absolute(folderPath), workerCount);
+        if (workers.empty()) return 1;
+
+        if (!signaturePath.empty()) {
+            return runShardedQuery(workers, "S " + fs::absolute(signaturePath).string()) ? 0 : 2;
+        }
+        if (!argPattern.empty()) {
+            return runShardedQuery(workers, "P " + argPattern) ? 0 : 2;
+        }
+    }
+
+    // An attached corpus replaces the builds folder, so a single positional is the pattern.
+    std::optional<Corpus> corpus;
+    if (!attachName.empty()) {
+        corpus = attachCorpus(attachName);
+        if (!corpus.has_value()) return 1;
+        if (argPattern.empty() && folderPath != "Builds/") argPattern = folderPath.string();
+    }
+
+    if (hardenMode) {
+        auto pattern = parseBytePattern(argPattern);
+        if (countFixedBytes(pattern) == 0) {
+            std::cerr << "--harden needs a pattern.\n";
+            return 1;
+        }
+
+        return hardenPattern(folderPath, pattern) ? 0 : 2;
+    }
+
+    if (minimizeMode) {
+        auto pattern = parseBytePattern(argPattern);
+        if (countFixedBytes(pattern) == 0) {
+            std::cerr << "--minimize needs a pattern.\n";
+            return 1;
+        }
+
+        return minimizePattern(folderPath, pattern) ? 0 : 2;
+    }
+
+    if (!needlePath.empty()) {
+        return scanNeedleFile(folderPath, needlePath, needleMaskPath) ? 0 : 2;
+    }
+
+    if (!symbolsInput.empty()) {
+        const auto buildPath = resolveBuildPath(folderPath, symbolsBuild);
+        if (!buildPath.has_value()) return 1;
+        return importSymbols(symbolsInput, *buildPath) ? 0 : 1;
+    }
+
+    if (!diffA.empty()) {
+        const auto pathA = resolveBuildPath(folderPath, diffA);
+        const auto pathB = resolveBuildPath(folderPath, diffB);
+        if (!pathA.has_value() || !pathB.has_value()) return 1;
+
+        return diffBuilds(*pathA, *pathB) ? 0 : 1;
+    }
+
+    if (!revalidateOld.empty()) {
+        std::optional<SignatureDatabase> database;
+        if (!signaturePath.empty()) {
+            database = loadSignatureDatabase(signaturePath);
+        } else if (!argPattern.empty()) {
+            SignatureSource source{ "pattern", "", parseBytePattern(argPattern) };
+            if (countFixedBytes(source.pattern) > 0) {
+                database.emplace();
+                database->loadImage(compileSignatureDatabase({ source }));
+            }
+        }
+        if (!database.has_value()) {
+            std::cerr << "--revalidate needs --sigs <file> or a pattern.\n";
+            return 1;
+        }
+
+        const auto oldPath = resolveBuildPath(folderPath, revalidateOld);
+        const auto newPath = resolveBuildPath(folderPath, revalidateNew);
+        if (!oldPath.has_value() || !newPath.has_value()) return 1;
+
+        bool ok = revalidateSignatures(*oldPath, *newPath, *database);
+        return ok ? 0 : 2;
+    }
+
+    if (!signaturePath.empty()) {
+        auto database = loadSignatureDatabase(signaturePath);
+        if (!database.has_value()) return 1;
+
+        if (corpus.has_value()) {
+            return scanCorpus(*corpus, nullptr, &*database) ? 0 : 2;
+        }
+
+        bool ok = csvOutput ? exportSignatureCsv(folderPath, *database) : scanSignatureDirectory(folderPath, *database);
+        return ok ? 0 : 2;
+    }
+
     if (!argPattern.empty())
     {
-        auto pattern = parseBytePattern(argPattern);
+        std::vector<Capture> captures;
+        auto pattern = parseBytePattern(argPattern, &captures);
 
         if (pattern.empty())
         {
@@ -386,15 +6196,24 @@ int main(int argc, char* argv[])
             return 1;
         }
 
-        bool ok = scanDirectory(folderPath, pattern);
+        if (csvOutput) {
+            return exportPatternCsv(folderPath, pattern, captures) ? 0 : 2;
+        }
+
+        if (corpus.has_value()) {
+            return scanCorpus(*corpus, &pattern, nullptr) ? 0 : 2;
+        }
+
+        bool ok = maxEditDistance > 0 ? scanEditDistance(folderPath, pattern) : scanDirectory(folderPath, pattern);
         return ok ? 0 : 2;
     }
 
-    if (!fs::exists(folderPath) || !fs::is_directory(folderPath)) {
+    if (!corpus.has_value() && (!fs::exists(folderPath) || !fs::is_directory(folderPath))) {
         std::cerr << "Can't find the builds path at: " << folderPath << ".\n";
         return 1;
     }
 
+    interactiveMode = true;
     while(true)
     {
         std::cout << "> ";
@@ -409,7 +6228,10 @@ int main(int argc, char* argv[])
             break;
         }
 
-        scanDirectory(folderPath, pattern);
+        if (!workers.empty()) runShardedQuery(workers, "P " + input);
+        else if (corpus.has_value()) scanCorpus(*corpus, &pattern, nullptr);
+        else if (maxEditDistance > 0) scanEditDistance(folderPath, pattern);
+        else scanDirectory(folderPath, pattern);
         std::cout << "\n";
     }
     